@@ -0,0 +1,98 @@
+// Producers push audio blocks while a consumer reads at a UI rate. Compares
+// mt_meter_property against setting an mt_property with the block peak.
+
+#include <v.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE { 64 };
+constexpr std::size_t BLOCKS { 200'000 };
+constexpr auto CONSUMER_PERIOD { std::chrono::milliseconds { 16 } };
+
+using clock_type = std::chrono::steady_clock;
+
+template <class Push, class Consume>
+auto run(std::size_t producers, Push push, Consume consume) -> double
+{
+	std::atomic<bool> done { false };
+
+	std::thread consumer { [&]
+	{
+		while (!done.load(std::memory_order_relaxed))
+		{
+			consume();
+			std::this_thread::sleep_for(CONSUMER_PERIOD);
+		}
+	}};
+
+	std::vector<std::thread> threads;
+
+	const auto start { clock_type::now() };
+
+	for (std::size_t t = 0; t < producers; t++)
+	{
+		threads.emplace_back([&push, t]
+		{
+			std::vector<float> block(BLOCK_SIZE);
+
+			for (std::size_t j = 0; j < BLOCK_SIZE; j++) block[j] = std::sin(float(t + j));
+
+			for (std::size_t i = 0; i < BLOCKS; i++)
+			{
+				block[0] = float(i % 1024) / 1024.0f;
+				push(block.data(), block.size());
+			}
+		});
+	}
+
+	for (auto& thread : threads) thread.join();
+
+	const auto elapsed { clock_type::now() - start };
+
+	done = true;
+	consumer.join();
+
+	return std::chrono::duration<double, std::nano>(elapsed).count() / double(BLOCKS);
+}
+
+} // namespace
+
+int main()
+{
+	std::printf("%-10s %18s %18s\n", "producers", "meter ns/block", "property ns/block");
+
+	for (const auto producers : { 1u, 2u, 4u, 8u })
+	{
+		v::mt::mt_meter_property<float> meter;
+		v::mt::mt_property<float> property;
+
+		float seen {};
+
+		auto meter_cn { meter >> [&] { seen = meter->peak; } };
+		auto property_cn { property >> [&] { seen = *property; } };
+
+		const auto meter_ns { run(producers,
+			[&](const float* samples, std::size_t count) { meter.push(samples, count); },
+			[&] { meter.flush(); }) };
+
+		const auto property_ns { run(producers,
+			[&](const float* samples, std::size_t count)
+			{
+				auto peak { 0.0f };
+
+				for (std::size_t i = 0; i < count; i++) peak = std::max(peak, std::abs(samples[i]));
+
+				property.set(peak);
+			},
+			[&] { (void)*property; }) };
+
+		std::printf("%-10u %18.1f %18.1f\n", producers, meter_ns, property_ns);
+	}
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+// Threads notify one shared signal with a few cheap slots. Compares the
+// mutex based mt_signal against the spinlock based mt_spin_signal as the
+// number of contending threads grows.
+
+#include <v.hpp>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t SLOTS { 4 };
+constexpr std::size_t NOTIFICATIONS { 400'000 };
+
+using clock_type = std::chrono::steady_clock;
+
+template <class Signal>
+auto run(std::size_t threads) -> double
+{
+	Signal signal;
+	std::atomic<std::size_t> calls { 0 };
+	v::store connections;
+
+	for (std::size_t i = 0; i < SLOTS; i++)
+	{
+		connections += signal >> [&calls] { calls.fetch_add(1, std::memory_order_relaxed); };
+	}
+
+	const auto per_thread { NOTIFICATIONS / threads };
+
+	std::vector<std::thread> workers;
+
+	const auto start { clock_type::now() };
+
+	for (std::size_t t = 0; t < threads; t++)
+	{
+		workers.emplace_back([&signal, per_thread]
+		{
+			for (std::size_t i = 0; i < per_thread; i++) signal();
+		});
+	}
+
+	for (auto& worker : workers) worker.join();
+
+	const auto elapsed { clock_type::now() - start };
+
+	return std::chrono::duration<double, std::nano>(elapsed).count() / double(per_thread * threads);
+}
+
+} // namespace
+
+int main()
+{
+	std::printf("%-8s %16s %16s\n", "threads", "mutex ns/notify", "spin ns/notify");
+
+	for (const auto threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u })
+	{
+		const auto mutex_ns { run<v::mt::mt_signal<void()>>(threads) };
+		const auto spin_ns { run<v::mt::mt_spin_signal<void()>>(threads) };
+
+		std::printf("%-8u %16.1f %16.1f\n", threads, mutex_ns, spin_ns);
+	}
+
+	return 0;
+}
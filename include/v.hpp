@@ -1,9 +1,67 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iterator>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <boost/container/small_vector.hpp>
 #include <boost/signals2.hpp>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#if __has_include(<sys/eventfd.h>)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define V_EVENTFD 1
+#else
+#define V_EVENTFD 0
+#endif
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define V_SHARED_MEMORY 1
+#else
+#define V_SHARED_MEMORY 0
+#endif
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define V_COROUTINES 1
+#else
+#define V_COROUTINES 0
+#endif
 
 namespace v {
 
@@ -11,396 +69,4828 @@ template <class T> using slot = boost::signals2::slot<T>;
 using cn = boost::signals2::connection;
 using scoped_cn = boost::signals2::scoped_connection;
 
+class intrusive_cn;
+
 namespace detail {
 
-template <typename SignalType>
-struct signal_base
+// Implemented by signals which store their own slots and hand out
+// intrusive_cn handles instead of boost connections.
+class slot_owner
 {
-	template <typename Slot>
-	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
-
-	template <typename Slot>
-	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+public:
 
-	template <class ... Args>
-	auto notify(Args && ... args) { return signal_(std::forward<Args>(args)...); }
+	virtual auto disconnect(std::uint32_t id) -> void = 0;
+	virtual auto rebind(std::uint32_t id, intrusive_cn* cn) -> void = 0;
 
-	template <class ... Args>
-	auto operator()(Args && ... args) { return notify(std::forward<Args>(args)...); }
+protected:
 
-private:
+	~slot_owner() = default;
 
-	SignalType signal_;
+	static auto make_cn(slot_owner* owner, std::uint32_t id) -> intrusive_cn;
+	static auto reown(intrusive_cn* cn, slot_owner* owner) -> void;
 };
 
-template <class T>
-using boost_signal = typename boost::signals2::signal_type<T, boost::signals2::keywords::mutex_type<boost::signals2::dummy_mutex>>::type;
-
-template <class T>
-using boost_mt_signal = boost::signals2::signal<T>;
-
 } // detail
 
-class store
+// Owning handle to a slot stored inside the signal itself. Creating one
+// allocates nothing: the signal keeps a pointer back to the handle, so
+// whichever of the two is destroyed first detaches the other. Like
+// scoped_cn, the slot is disconnected when the handle is destroyed unless
+// release() is called first.
+class [[nodiscard]] intrusive_cn
 {
 public:
 
-	auto operator+=(scoped_cn && c) -> void
+	intrusive_cn() = default;
+	intrusive_cn(const intrusive_cn& rhs) = delete;
+	intrusive_cn& operator=(const intrusive_cn& rhs) = delete;
+
+	intrusive_cn(intrusive_cn && rhs) noexcept
+		: owner_ { std::exchange(rhs.owner_, nullptr) }
+		, id_ { rhs.id_ }
 	{
-		connections_.push_back(std::move(c));
+		if (owner_) owner_->rebind(id_, this);
 	}
 
-private:
+	intrusive_cn& operator=(intrusive_cn && rhs) noexcept
+	{
+		if (&rhs == this) return *this;
 
-	std::vector<scoped_cn> connections_;
-};
+		disconnect();
 
-template <class Observer>
-class value_cn
-{
-public:
+		owner_ = std::exchange(rhs.owner_, nullptr);
+		id_ = rhs.id_;
 
-	using slot_t = std::function<void()>;
+		if (owner_) owner_->rebind(id_, this);
 
-	value_cn() = default;
-	value_cn(const value_cn& rhs) = default;
-	value_cn(value_cn && rhs) = default;
-	value_cn& operator=(const value_cn& rhs) = default;
-	value_cn& operator=(value_cn && rhs) = default;
+		return *this;
+	}
 
-	value_cn(Observer observer, slot_t slot, bool start_disconnected = false)
-		: observer_ { observer }
-		, slot_ { slot }
+	~intrusive_cn()
 	{
-		if (!start_disconnected) connect();
+		disconnect();
 	}
 
-	auto connect()
+	auto disconnect() -> void
 	{
-		connection_ = observer_.observe(slot_);
+		if (!owner_) return;
+
+		std::exchange(owner_, nullptr)->disconnect(id_);
 	}
 
-	auto disconnect()
+	auto release() -> void
 	{
-		connection_.disconnect();
+		if (!owner_) return;
+
+		std::exchange(owner_, nullptr)->rebind(id_, nullptr);
 	}
 
-	auto slot() const { slot_(); }
-	auto get() const { return observer_.get(); }
-	auto operator*() const { return get(); }
+	auto connected() const -> bool { return owner_; }
 
 private:
 
-	Observer observer_;
-	slot_t slot_;
-	scoped_cn connection_;
+	intrusive_cn(detail::slot_owner* owner, std::uint32_t id)
+		: owner_ { owner }
+		, id_ { id }
+	{
+		owner_->rebind(id_, this);
+	}
+
+	friend class detail::slot_owner;
+
+	detail::slot_owner* owner_ {};
+	std::uint32_t id_ {};
 };
 
-template <class T>
-class property_observer
+// Fork-join pool used for parallel slot dispatch. Each worker has its own
+// task deque and steals from the others when it runs dry. The thread which
+// calls run_all() works on the batch too, so calling it from inside a
+// worker can't deadlock. If fn throws, the rest of the batch still runs and
+// run_all() rethrows the first exception once every call has finished.
+class thread_pool
 {
 public:
 
-	using connector_t = std::function<cn(slot<void()>)>;
+	explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1)
+	{
+		for (std::size_t i = 0; i < threads; i++) workers_.push_back(std::make_unique<worker>());
+		for (std::size_t i = 0; i < threads; i++) threads_.emplace_back([this, i]() { run(i); });
+	}
 
-	property_observer() = default;
-	property_observer(const property_observer& rhs) = default;
-	property_observer(property_observer && rhs) = default;
-	property_observer& operator=(const property_observer& rhs) = default;
-	property_observer& operator=(property_observer && rhs) = default;
+	~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock { sleep_mutex_ };
 
-	property_observer(const T* value, connector_t connector)
-		: value_ { value }
-		, connector_ { connector }
-	{}
+			stop_ = true;
+		}
 
-	auto get() const { return *value_; }
-	auto operator*() const { return get(); }
+		wake_.notify_all();
 
-	template <typename Slot>
-	auto observe(Slot && slot) { return connector_(std::forward<Slot>(slot)); }
+		for (auto& thread : threads_) thread.join();
+	}
 
-	template <typename Slot>
-	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+	template <class Fn>
+	auto run_all(std::size_t count, Fn && fn) -> void
+	{
+		if (count == 0) return;
 
-private:
+		const auto batch { std::make_shared<job>() };
 
-	const T* value_ {};
-	connector_t connector_;
-};
+		batch->count = count;
+		batch->fn = [&fn](std::size_t index) { fn(index); };
 
-template <class T>
-class getter_observer
-{
-public:
+		const auto work { [batch]()
+		{
+			for (auto index { batch->next++ }; index < batch->count; index = batch->next++)
+			{
+				try
+				{
+					batch->fn(index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock { batch->mutex };
+
+					if (!batch->error) batch->error = std::current_exception();
+				}
+
+				if (++batch->done == batch->count)
+				{
+					std::lock_guard<std::mutex> lock { batch->mutex };
+
+					batch->finished.notify_all();
+				}
+			}
+		}};
 
-	using getter_t = std::function<T()>;
-	using connector_t = std::function<cn(slot<void()>)>;
+		for (std::size_t i = 0; i < std::min(count - 1, workers_.size()); i++) push(work);
 
-	getter_observer() = default;
-	getter_observer(const getter_observer& rhs) = default;
-	getter_observer(getter_observer && rhs) = default;
-	getter_observer& operator=(const getter_observer& rhs) = default;
-	getter_observer& operator=(getter_observer && rhs) = default;
+		work();
 
-	getter_observer(getter_t getter, connector_t connector)
-		: getter_ { getter }
-		, connector_ { connector }
-	{
-	}
+		std::unique_lock<std::mutex> lock { batch->mutex };
 
-	auto get() const { return getter_(); }
-	auto operator()() const { return get(); }
-	operator bool() const { return bool(getter_); }
+		batch->finished.wait(lock, [&batch]() { return batch->done == batch->count; });
 
-	template <typename Slot>
-	auto observe(Slot && slot) { return connector_(std::forward<Slot>(slot)); }
+		if (batch->error) std::rethrow_exception(batch->error);
+	}
 
-	template <typename Slot>
-	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+	static auto shared() -> thread_pool&
+	{
+		static thread_pool pool;
+
+		return pool;
+	}
 
 private:
 
-	getter_t getter_;
-	connector_t connector_;
-};
+	using task = std::function<void()>;
 
-template <class T> using property_cn = value_cn<property_observer<T>>;
-template <class T> using getter_cn = value_cn<getter_observer<T>>;
+	struct worker
+	{
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
 
-namespace detail {
+	struct job
+	{
+		std::atomic<std::size_t> next { 0 };
+		std::atomic<std::size_t> done { 0 };
+		std::size_t count {};
+		std::function<void(std::size_t)> fn;
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr error;
+	};
+
+	auto push(task t) -> void
+	{
+		auto& target { *workers_[next_worker_++ % workers_.size()] };
 
-template <class T, class SignalType>
-class read_only_property_base;
+		{
+			std::lock_guard<std::mutex> lock { target.mutex };
 
-template <class T, class SignalType>
-class property_setter_base
-{
-public:
+			target.tasks.push_back(std::move(t));
+		}
 
-	property_setter_base(property_setter_base && rhs) = default;
+		{
+			std::lock_guard<std::mutex> lock { sleep_mutex_ };
 
-	property_setter_base(read_only_property_base<T, SignalType>* property)
-		: property_{ property }
-	{
+			queued_++;
+		}
+
+		wake_.notify_one();
 	}
 
-	template <class U>
-	auto& operator=(U && value)
+	auto try_pop(std::size_t index, task& out) -> bool
 	{
-		set(std::forward<U>(value));
+		for (std::size_t i = 0; i < workers_.size(); i++)
+		{
+			auto& victim { *workers_[(index + i) % workers_.size()] };
 
-		return *this;
+			std::lock_guard<std::mutex> lock { victim.mutex };
+
+			if (victim.tasks.empty()) continue;
+
+			if (i == 0)
+			{
+				out = std::move(victim.tasks.back());
+				victim.tasks.pop_back();
+			}
+			else
+			{
+				out = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+			}
+
+			return true;
+		}
+
+		return false;
 	}
 
-	template <class U>
-	auto set(U && value, bool notify = true, bool force = false) -> void
+	auto run(std::size_t index) -> void
 	{
-		property_->set(std::forward<U>(value), notify, force);
-	}
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock { sleep_mutex_ };
 
-private:
+				wake_.wait(lock, [this]() { return stop_ || queued_ > 0; });
 
-	read_only_property_base<T, SignalType>* property_;
+				if (stop_) return;
+
+				queued_--;
+			}
+
+			task t;
+
+			if (try_pop(index, t)) t();
+		}
+	}
+
+	std::vector<std::unique_ptr<worker>> workers_;
+	std::vector<std::thread> threads_;
+	std::atomic<std::size_t> next_worker_ { 0 };
+	std::mutex sleep_mutex_;
+	std::condition_variable wake_;
+	std::size_t queued_ { 0 };
+	bool stop_ { false };
 };
 
-template <class T, class SignalType>
-class read_only_property_base
-{
-public:
+struct independent_t {};
 
-	read_only_property_base() : value_ {} {}
-	read_only_property_base(T value) : value_ { value } {}
-	read_only_property_base(read_only_property_base<T, SignalType> && rhs) = default;
+inline constexpr independent_t independent {};
 
-	bool operator==(const T& value) const { return value_ == value; }
+// Observing a property with becomes(x) only runs the slot when the
+// property changes to x. rising and falling are the same for bool.
+template <class T> struct value_key { T value; };
+template <class T> auto becomes(T value) { return value_key<T> { std::move(value) }; }
 
-	auto notify() -> void
+inline constexpr value_key<bool> rising { true };
+inline constexpr value_key<bool> falling { false };
+
+// Filters for observe(slot, filter). A filter is called as
+// filter(old, now) with the values before and after the change and the
+// slot only runs if it returns true.
+namespace filter {
+
+// Passes once the value has moved more than delta away from where it was
+// the last time this filter passed.
+template <class D>
+auto changed_by_more_than(D delta)
+{
+	return [delta, reference = std::optional<D> {}](const auto& old, const auto& now) mutable
 	{
-		signal_();
-	}
+		if (!reference) reference = D(old);
 
-	template <typename Slot>
-	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+		const auto value { D(now) };
 
-	template <typename Slot>
-	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+		if ((value > *reference ? value - *reference : *reference - value) <= delta) return false;
 
-	auto observer()
-	{
-		const auto connect { [this](v::slot<void()> slot)
-		{
-			return signal_.connect(slot);
-		}};
+		reference = value;
 
-		return property_observer<T> { &value_, connect };
-	}
+		return true;
+	};
+}
 
-	auto& get() const { return value_; }
-	auto& operator*() const { return get(); }
-	auto operator->() const { return &value_; }
+template <class T>
+auto crossed(T threshold)
+{
+	return [threshold](const auto& old, const auto& now) { return (old < threshold) != (now < threshold); };
+}
 
-private:
+template <class T>
+auto entered_range(T min, T max)
+{
+	return [min, max](const auto& old, const auto& now) { return !(min <= old && old <= max) && (min <= now && now <= max); };
+}
 
-	template <class U>
-	auto& operator=(U && value)
-	{
-		set(std::forward<U>(value));
+template <class T>
+auto exited_range(T min, T max)
+{
+	return [min, max](const auto& old, const auto& now) { return (min <= old && old <= max) && !(min <= now && now <= max); };
+}
 
-		return *this;
-	}
+template <class... Filters>
+auto all(Filters... filters)
+{
+	return [filters...](const auto& old, const auto& now) mutable { return (filters(old, now) && ...); };
+}
 
-	template <class U>
-	auto set(U && value, bool notify = true, bool force = false) -> void
-	{
-		if (value == value_ && !force) return;
+template <class... Filters>
+auto any(Filters... filters)
+{
+	return [filters...](const auto& old, const auto& now) mutable { return (filters(old, now) || ...); };
+}
 
-		value_ = std::forward<U>(value);
+} // filter
 
-		if (notify) this->notify();
-	}
+using field_mask = std::uint64_t;
 
-	friend class property_setter_base<T, SignalType>;
+template <auto... Members> struct fields {};
 
-	T value_;
-	SignalType signal_;
+enum class overflow_policy
+{
+	terminate,
+	drop,
 };
 
-template <class T, class SignalType>
-class property_base : public read_only_property_base<T, SignalType>
+namespace threading {
+
+struct none {};
+struct spinlock {};
+struct mutex {};
+struct lock_free {};
+
+} // threading
+
+namespace storage {
+
+struct heap {};
+template <std::size_t N> struct small_vector {};
+template <std::size_t N, overflow_policy Overflow = overflow_policy::terminate> struct inline_n {};
+
+} // storage
+
+namespace dispatch {
+
+struct sync {};
+struct queued {};
+struct fifo {};
+
+} // dispatch
+
+namespace detail {
+
+inline auto slot_owner::make_cn(slot_owner* owner, std::uint32_t id) -> intrusive_cn
 {
-public:
+	return { owner, id };
+}
 
-	property_base()
-		: setter_{ this }
+inline auto slot_owner::reown(intrusive_cn* cn, slot_owner* owner) -> void
+{
+	cn->owner_ = owner;
+}
+
+template <class Fn, class Object, class... Args>
+auto call_delegate(Fn fn, Object* object, Args&&... args) -> void
+{
+	if constexpr (std::is_member_function_pointer_v<Fn>)
+	{
+		(object->*fn)(std::forward<Args>(args)...);
+	}
+	else
 	{
+		fn(object, std::forward<Args>(args)...);
 	}
+}
+
+// Slots registered as (function, object) pairs, where the function is a
+// member function of the object or a free function taking the object as
+// its first argument. Pairs are grouped by function, so each slot costs
+// one object pointer. Connecting does allocate: the first pair for a
+// function creates its group, and the groups' object vectors and the id
+// table grow as slots are added. Notifying makes one indirect call per
+// group, which then loops over that group's contiguous object pointers
+// calling the function directly. Connection ids index a table of slot
+// positions, so disconnecting and rebinding a handle don't search the
+// groups.
+//
+// Signals with inline or small vector storage don't use this; they store
+// the (object, function) pair inline in the slot itself.
+template <class Signature, class Mutex>
+class batch_slots;
+
+template <class... Args, class Mutex>
+class batch_slots<void(Args...), Mutex> final : public slot_owner
+{
+public:
 
-	property_base(const T & value)
-		: read_only_property_base<T, SignalType> { value }
-		, setter_{ this }
+	batch_slots() = default;
+	batch_slots(const batch_slots& rhs) = delete;
+	batch_slots& operator=(const batch_slots& rhs) = delete;
+
+	~batch_slots()
 	{
+		for_each_cn([](intrusive_cn* cn) { reown(cn, nullptr); });
 	}
 
-	property_base(property_base && rhs)
-		: read_only_property_base<T, SignalType> { std::move(rhs) }
-		, setter_{ this }
+	template <auto Fn, class Object>
+	auto connect(Object* object) -> intrusive_cn
 	{
+		return connect(&invoke_static<Object, Fn>, {}, object);
 	}
 
-	template <class U>
-	auto& operator=(U && value)
+	template <class Object, class Fn>
+	auto connect(Object* object, Fn fn) -> intrusive_cn
 	{
-		setter_.operator=(std::forward<U>(value));
+		static_assert(std::is_member_function_pointer_v<Fn> || std::is_pointer_v<Fn>);
+		static_assert(sizeof(Fn) <= sizeof(fn_storage));
 
-		return *this;
+		fn_storage storage {};
+
+		std::memcpy(storage.bytes, &fn, sizeof(Fn));
+
+		return connect(&invoke_dynamic<Object, Fn>, storage, object);
 	}
 
-	auto set(const T& value, bool notify = true, bool force = false) -> void
+	auto operator()(Args... args) -> void
 	{
-		setter_.set(value, notify, force);
-	}
+		std::lock_guard<Mutex> lock { mutex_ };
 
-private:
+		if (groups_.empty()) return;
 
-	property_setter_base<T, SignalType> setter_;
-};
+		dispatching_++;
 
-template <class T, class SignalType>
-class one_shot_property_base : public property_base<T, SignalType>
-{
-public:
+		for (const auto& group : groups_)
+		{
+			group->invoke(group->fn, group->objects.data(), group->objects.size(), args...);
+		}
 
-	one_shot_property_base(const T & value)
-		: property_base<T, SignalType> { value }
-	{
+		if (--dispatching_ == 0) flush();
 	}
 
-	template <class U>
-	auto& operator=(U && value)
+	auto disconnect(std::uint32_t id) -> void override
 	{
-		if (flag_) return *this;
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		const auto [target, index] { locations_[id] };
+
+		free_ids_.push_back(id);
+
+		if (!target)
+		{
+			remove_pending(index);
+		}
+		else if (dispatching_ > 0)
+		{
+			target->objects[index] = nullptr;
+			target->cns[index] = nullptr;
+			dirty_ = true;
+		}
+		else
+		{
+			remove(target, index);
+		}
+	}
+
+	auto rebind(std::uint32_t id, intrusive_cn* cn) -> void override
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		const auto [target, index] { locations_[id] };
+
+		if (target) target->cns[index] = cn;
+		else pending_[index].cn = cn;
+	}
+
+private:
+
+	struct fn_storage
+	{
+		alignas(void*) unsigned char bytes[sizeof(void*) * 4];
+
+		auto operator==(const fn_storage& rhs) const { return std::memcmp(bytes, rhs.bytes, sizeof(bytes)) == 0; }
+	};
+
+	using invoke_fn = void(*)(const fn_storage& fn, void* const* objects, std::size_t count, Args... args);
+
+	struct group
+	{
+		invoke_fn invoke;
+		fn_storage fn;
+		std::vector<void*> objects;
+		std::vector<std::uint32_t> ids;
+		std::vector<intrusive_cn*> cns;
+	};
+
+	struct pending
+	{
+		invoke_fn invoke;
+		fn_storage fn;
+		void* object;
+		std::uint32_t id;
+		intrusive_cn* cn {};
+	};
+
+	// Where a connection's slot is. A null group means index is into the
+	// pending list.
+	struct location
+	{
+		group* target;
+		std::size_t index;
+	};
+
+	template <class Object, auto Fn>
+	static auto invoke_static(const fn_storage&, void* const* objects, std::size_t count, Args... args) -> void
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			if (objects[i]) call_delegate(Fn, static_cast<Object*>(objects[i]), args...);
+		}
+	}
+
+	template <class Object, class Fn>
+	static auto invoke_dynamic(const fn_storage& storage, void* const* objects, std::size_t count, Args... args) -> void
+	{
+		Fn fn;
+
+		std::memcpy(&fn, storage.bytes, sizeof(Fn));
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			if (objects[i]) call_delegate(fn, static_cast<Object*>(objects[i]), args...);
+		}
+	}
+
+	auto connect(invoke_fn invoke, const fn_storage& fn, void* object) -> intrusive_cn
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		const auto id { make_id() };
+
+		if (dispatching_ > 0)
+		{
+			pending_.push_back({ invoke, fn, object, id });
+			locations_[id] = { nullptr, pending_.size() - 1 };
+		}
+		else
+		{
+			add(invoke, fn, object, id);
+		}
+
+		return make_cn(this, id);
+	}
+
+	auto make_id() -> std::uint32_t
+	{
+		if (free_ids_.empty())
+		{
+			locations_.emplace_back();
+
+			return std::uint32_t(locations_.size() - 1);
+		}
+
+		const auto id { free_ids_.back() };
+
+		free_ids_.pop_back();
+
+		return id;
+	}
+
+	auto add(invoke_fn invoke, const fn_storage& fn, void* object, std::uint32_t id, intrusive_cn* cn = nullptr) -> void
+	{
+		auto pos { std::find_if(groups_.begin(), groups_.end(), [invoke, &fn](const auto& g) { return g->invoke == invoke && g->fn == fn; }) };
+
+		if (pos == groups_.end()) pos = groups_.insert(groups_.end(), std::make_unique<group>(group { invoke, fn, {}, {}, {} }));
+
+		const auto target { pos->get() };
+
+		target->objects.push_back(object);
+		target->ids.push_back(id);
+		target->cns.push_back(cn);
+
+		locations_[id] = { target, target->objects.size() - 1 };
+	}
+
+	// Moves the group's last slot into the gap, so the order of slots
+	// within a group isn't preserved.
+	auto remove(group* target, std::size_t index) -> void
+	{
+		const auto last { target->objects.size() - 1 };
+
+		if (index != last)
+		{
+			target->objects[index] = target->objects[last];
+			target->ids[index] = target->ids[last];
+			target->cns[index] = target->cns[last];
+			locations_[target->ids[index]].index = index;
+		}
+
+		target->objects.pop_back();
+		target->ids.pop_back();
+		target->cns.pop_back();
+
+		if (target->objects.empty()) erase_group(target);
+	}
+
+	auto remove_pending(std::size_t index) -> void
+	{
+		if (index != pending_.size() - 1)
+		{
+			pending_[index] = pending_.back();
+			locations_[pending_[index].id].index = index;
+		}
+
+		pending_.pop_back();
+	}
+
+	auto erase_group(group* target) -> void
+	{
+		groups_.erase(std::find_if(groups_.begin(), groups_.end(), [target](const auto& g) { return g.get() == target; }));
+	}
+
+	auto flush() -> void
+	{
+		if (dirty_)
+		{
+			for (const auto& group : groups_)
+			{
+				std::size_t out { 0 };
+
+				for (std::size_t i = 0; i < group->objects.size(); i++)
+				{
+					if (!group->objects[i]) continue;
+
+					group->objects[out] = group->objects[i];
+					group->ids[out] = group->ids[i];
+					group->cns[out] = group->cns[i];
+					locations_[group->ids[out]] = { group.get(), out };
+					out++;
+				}
+
+				group->objects.resize(out);
+				group->ids.resize(out);
+				group->cns.resize(out);
+			}
+
+			groups_.erase(std::remove_if(groups_.begin(), groups_.end(), [](const auto& g) { return g->objects.empty(); }), groups_.end());
+
+			dirty_ = false;
+		}
+
+		for (const auto& p : pending_) add(p.invoke, p.fn, p.object, p.id, p.cn);
+
+		pending_.clear();
+	}
+
+	template <class Fn>
+	auto for_each_cn(Fn && fn) -> void
+	{
+		for (const auto& group : groups_)
+		{
+			for (const auto cn : group->cns)
+			{
+				if (cn) fn(cn);
+			}
+		}
+
+		for (const auto& p : pending_)
+		{
+			if (p.cn) fn(p.cn);
+		}
+	}
+
+	Mutex mutex_;
+	std::vector<std::unique_ptr<group>> groups_;
+	std::vector<pending> pending_;
+	std::vector<location> locations_;
+	std::vector<std::uint32_t> free_ids_;
+	int dispatching_ { 0 };
+	bool dirty_ { false };
+};
+
+template <class Signature>
+class waiter_owner;
+
+// Intrusive node for something waiting on the next notification of a
+// signal, such as a suspended coroutine. It lives in the waiter's own
+// storage, so registering allocates nothing once the signal's waiter list
+// exists; signals create that list the first time anything waits on them.
+// A waiter is fired at most once per registration; it unlinks itself if
+// destroyed while registered.
+template <class Signature>
+struct waiter;
+
+template <class... Args>
+struct waiter<void(Args...)>
+{
+	using fire_fn = void(*)(waiter* self, Args... args);
+
+	waiter(fire_fn fn) : fire { fn } {}
+	waiter(const waiter& rhs) = delete;
+	waiter& operator=(const waiter& rhs) = delete;
+
+	~waiter()
+	{
+		if (const auto current { owner.load(std::memory_order_acquire) }) current->remove(this);
+	}
+
+	fire_fn fire;
+	std::atomic<waiter_owner<void(Args...)>*> owner { nullptr };
+	waiter* prev {};
+	waiter* next {};
+	std::uint32_t generation {};
+};
+
+template <class... Args>
+class waiter_owner<void(Args...)>
+{
+public:
+
+	// Returns false if w wasn't registered here, e.g. because it is being
+	// fired.
+	virtual auto remove(waiter<void(Args...)>* w) -> bool = 0;
+
+protected:
+
+	~waiter_owner() = default;
+};
+
+template <class Signature, class Mutex>
+class waiter_list;
+
+template <class... Args, class Mutex>
+class waiter_list<void(Args...), Mutex> final : public waiter_owner<void(Args...)>
+{
+public:
+
+	using waiter_t = waiter<void(Args...)>;
+
+	waiter_list() = default;
+	waiter_list(const waiter_list& rhs) = delete;
+	waiter_list& operator=(const waiter_list& rhs) = delete;
+
+	~waiter_list()
+	{
+		for (auto w { head_ }; w; w = w->next) w->owner.store(nullptr, std::memory_order_release);
+	}
+
+	auto add(waiter_t* w) -> void
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		w->generation = generation_;
+		w->prev = tail_;
+		w->next = nullptr;
+
+		if (tail_) tail_->next = w; else head_ = w;
+
+		tail_ = w;
+
+		w->owner.store(this, std::memory_order_release);
+		waiting_.store(true, std::memory_order_release);
+	}
+
+	auto remove(waiter_t* w) -> bool override
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		if (w->owner.load(std::memory_order_relaxed) != this) return false;
+
+		unlink(w);
+
+		return true;
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		if (!waiting_.load(std::memory_order_acquire)) return;
+
+		std::uint32_t generation;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			if (!head_) return;
+
+			generation = ++generation_;
+		}
+
+		for (;;)
+		{
+			waiter_t* w;
+
+			{
+				std::lock_guard<Mutex> lock { mutex_ };
+
+				w = head_;
+
+				if (!w || w->generation == generation) return;
+
+				unlink(w);
+			}
+
+			w->fire(w, args...);
+		}
+	}
+
+private:
+
+	auto unlink(waiter_t* w) -> void
+	{
+		if (w->prev) w->prev->next = w->next; else head_ = w->next;
+		if (w->next) w->next->prev = w->prev; else tail_ = w->prev;
+
+		w->prev = w->next = nullptr;
+		w->owner.store(nullptr, std::memory_order_release);
+
+		if (!head_) waiting_.store(false, std::memory_order_relaxed);
+	}
+
+	Mutex mutex_;
+	waiter_t* head_ {};
+	waiter_t* tail_ {};
+	std::uint32_t generation_ { 0 };
+	std::atomic<bool> waiting_ { false };
+};
+
+#if V_COROUTINES
+
+template <class Signal, class Signature>
+class next_awaiter;
+
+template <class Signal, class... Args>
+class next_awaiter<Signal, void(Args...)> : waiter<void(Args...)>
+{
+public:
+
+	next_awaiter(Signal& signal)
+		: waiter<void(Args...)> { &fired }
+		, signal_ { signal }
+	{
+	}
+
+	auto await_ready() const { return false; }
+
+	auto await_suspend(std::coroutine_handle<> handle) -> void
+	{
+		handle_ = handle;
+		signal_.add_waiter(this);
+	}
+
+	auto await_resume()
+	{
+		if constexpr (sizeof...(Args) == 0) return;
+		else if constexpr (sizeof...(Args) == 1) return std::get<0>(std::move(*args_));
+		else return std::move(*args_);
+	}
+
+private:
+
+	static auto fired(waiter<void(Args...)>* self, Args... args) -> void
+	{
+		auto& awaiter { static_cast<next_awaiter&>(*self) };
+
+		awaiter.args_.emplace(args...);
+		awaiter.handle_.resume();
+	}
+
+	Signal& signal_;
+	std::coroutine_handle<> handle_;
+	std::optional<std::tuple<std::decay_t<Args>...>> args_;
+};
+
+// Resumes on the first notification after which Pred holds for the
+// source's value, or immediately if it already holds. Pred = std::nullptr_t
+// resumes on the next notification regardless. Pred sees the source's
+// copy(), which another thread can't be halfway through setting.
+template <class Signal, class Source, class Pred>
+class value_awaiter : waiter<void()>
+{
+public:
+
+	value_awaiter(Signal& signal, const Source& source, Pred pred)
+		: waiter<void()> { &fired }
+		, signal_ { signal }
+		, source_ { source }
+		, pred_ { std::move(pred) }
+	{
+	}
+
+	auto await_ready() const -> bool
+	{
+		if constexpr (std::is_null_pointer_v<Pred>) return false;
+		else return pred_(source_.copy());
+	}
+
+	// The value can change between await_ready() and registering, and that
+	// change doesn't fire this waiter, so pred is tested again once it is
+	// registered. A notification which arrives before this returns doesn't
+	// resume the coroutine itself; it leaves that to the return value.
+	auto await_suspend(std::coroutine_handle<> handle) -> bool
+	{
+		handle_ = handle;
+		state_.store(SUSPENDING, std::memory_order_relaxed);
+		signal_.add_waiter(this);
+
+		if constexpr (!std::is_null_pointer_v<Pred>)
+		{
+			if (pred_(source_.copy()) && unregister()) return false;
+		}
+
+		auto expected { SUSPENDING };
+
+		return state_.compare_exchange_strong(expected, SUSPENDED, std::memory_order_acq_rel);
+	}
+
+	auto await_resume() const { return source_.copy(); }
+
+private:
+
+	static constexpr int SUSPENDING { 0 };
+	static constexpr int SUSPENDED { 1 };
+	static constexpr int FIRED { 2 };
+
+	static auto fired(waiter<void()>* self) -> void
+	{
+		auto& awaiter { static_cast<value_awaiter&>(*self) };
+
+		if constexpr (!std::is_null_pointer_v<Pred>)
+		{
+			if (!awaiter.pred_(awaiter.source_.copy()))
+			{
+				awaiter.signal_.add_waiter(self);
+				return;
+			}
+		}
+
+		if (awaiter.state_.exchange(FIRED, std::memory_order_acq_rel) == SUSPENDED) awaiter.handle_.resume();
+	}
+
+	// Returns false if a notification has already taken the waiter.
+	auto unregister() -> bool
+	{
+		const auto current { owner.load(std::memory_order_acquire) };
+
+		return current && current->remove(this);
+	}
+
+	Signal& signal_;
+	const Source& source_;
+	Pred pred_;
+	std::coroutine_handle<> handle_;
+	std::atomic<int> state_ { SUSPENDING };
+};
+
+// Stays registered on the signal for its whole lifetime and queues every
+// emission, so nothing is missed between two calls to next().
+template <class Signal, class Signature>
+class emission_stream;
+
+template <class Signal, class... Args>
+class emission_stream<Signal, void(Args...)> : waiter<void(Args...)>
+{
+public:
+
+	using value_type = std::tuple<std::decay_t<Args>...>;
+
+	emission_stream(Signal& signal)
+		: waiter<void(Args...)> { &fired }
+		, signal_ { signal }
+	{
+		signal_.add_waiter(this);
+	}
+
+	auto next()
+	{
+		struct awaiter
+		{
+			emission_stream& stream;
+
+			auto await_ready() const { return false; }
+
+			auto await_suspend(std::coroutine_handle<> handle) -> bool
+			{
+				std::lock_guard<std::mutex> lock { stream.mutex_ };
+
+				if (!stream.queue_.empty()) return false;
+
+				stream.handle_ = handle;
+
+				return true;
+			}
+
+			auto await_resume()
+			{
+				std::lock_guard<std::mutex> lock { stream.mutex_ };
+
+				auto args { std::move(stream.queue_.front()) };
+
+				stream.queue_.pop_front();
+
+				if constexpr (sizeof...(Args) == 0) return;
+				else if constexpr (sizeof...(Args) == 1) return std::get<0>(std::move(args));
+				else return args;
+			}
+		};
+
+		return awaiter { *this };
+	}
+
+private:
+
+	static auto fired(waiter<void(Args...)>* self, Args... args) -> void
+	{
+		auto& stream { static_cast<emission_stream&>(*self) };
+
+		stream.signal_.add_waiter(self);
+
+		std::coroutine_handle<> handle;
+
+		{
+			std::lock_guard<std::mutex> lock { stream.mutex_ };
+
+			stream.queue_.emplace_back(args...);
+			handle = std::exchange(stream.handle_, {});
+		}
+
+		if (handle) handle.resume();
+	}
+
+	Signal& signal_;
+	std::mutex mutex_;
+	std::deque<value_type> queue_;
+	std::coroutine_handle<> handle_;
+};
+
+#endif
+
+template <typename SignalType>
+struct signal_base
+{
+	using signature = typename SignalType::waiter_signature;
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto observe(independent_t, Slot && slot) { return signal_.connect(independent, std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	template <class ... Args>
+	auto notify(Args && ... args) { return signal_(std::forward<Args>(args)...); }
+
+	template <class ... Args>
+	auto operator()(Args && ... args) { return notify(std::forward<Args>(args)...); }
+
+	auto flush() -> void { signal_.flush(); }
+
+#if V_COROUTINES
+	auto next() { return next_awaiter<SignalType, typename SignalType::waiter_signature> { signal_ }; }
+	auto emissions() { return emission_stream<SignalType, typename SignalType::waiter_signature> { signal_ }; }
+#endif
+
+private:
+
+	SignalType signal_;
+};
+
+// Slots flagged as independent of each other. A notification runs them
+// concurrently on the shared thread_pool and returns once all of them have
+// finished. Slots are held by shared_ptr so that one disconnected while a
+// notification is running stays alive until that notification is done.
+template <class Signature, class Mutex>
+class parallel_slots;
+
+template <class... Args, class Mutex>
+class parallel_slots<void(Args...), Mutex> final : public slot_owner
+{
+public:
+
+	~parallel_slots()
+	{
+		for (const auto& entry : entries_)
+		{
+			if (entry.cn) reown(entry.cn, nullptr);
+		}
+	}
+
+	template <class Slot>
+	auto connect(Slot && slot) -> intrusive_cn
+	{
+		auto fn { std::make_shared<fn_t>(std::forward<Slot>(slot)) };
+
+		std::uint32_t id;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			id = next_id_++;
+			entries_.push_back({ std::move(fn), id, nullptr });
+		}
+
+		return make_cn(this, id);
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		std::vector<std::shared_ptr<fn_t>> slots;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			if (entries_.empty()) return;
+
+			slots.reserve(entries_.size());
+
+			for (const auto& entry : entries_) slots.push_back(entry.fn);
+		}
+
+		thread_pool::shared().run_all(slots.size(), [&](std::size_t index) { (*slots[index])(args...); });
+	}
+
+	auto disconnect(std::uint32_t id) -> void override
+	{
+		std::shared_ptr<fn_t> trash;
+
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		const auto pos { std::find_if(entries_.begin(), entries_.end(), [id](const entry& e) { return e.id == id; }) };
+
+		if (pos == entries_.end()) return;
+
+		trash = std::move(pos->fn);
+		entries_.erase(pos);
+	}
+
+	auto rebind(std::uint32_t id, intrusive_cn* cn) -> void override
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		for (auto& entry : entries_)
+		{
+			if (entry.id == id) { entry.cn = cn; return; }
+		}
+	}
+
+private:
+
+	using fn_t = std::function<void(Args...)>;
+
+	struct entry
+	{
+		std::shared_ptr<fn_t> fn;
+		std::uint32_t id;
+		intrusive_cn* cn;
+	};
+
+	Mutex mutex_;
+	std::vector<entry> entries_;
+	std::uint32_t next_id_ { 0 };
+};
+
+// Owns something a signal only needs once it's used, so that signals which
+// never use it don't pay for it. The first get_or_create() allocates it;
+// threads racing to do so agree on one instance.
+template <class T>
+class lazy_ptr
+{
+public:
+
+	lazy_ptr() = default;
+	lazy_ptr(lazy_ptr && rhs) noexcept : ptr_ { rhs.ptr_.exchange(nullptr) } {}
+
+	~lazy_ptr()
+	{
+		delete ptr_.load();
+	}
+
+	auto get() const -> T* { return ptr_.load(std::memory_order_acquire); }
+
+	auto get_or_create() -> T&
+	{
+		if (const auto existing { get() }) return *existing;
+
+		auto created { std::make_unique<T>() };
+		T* expected { nullptr };
+
+		if (ptr_.compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel)) return *created.release();
+
+		return *expected;
+	}
+
+private:
+
+	std::atomic<T*> ptr_ { nullptr };
+};
+
+template <class Signature, class Mutex, class BatchMutex>
+class boost_signal_impl;
+
+template <class R, class... Args, class Mutex, class BatchMutex>
+class boost_signal_impl<R(Args...), Mutex, BatchMutex>
+	: public boost::signals2::signal_type<R(Args...), boost::signals2::keywords::mutex_type<Mutex>>::type
+{
+public:
+
+	using base_t = typename boost::signals2::signal_type<R(Args...), boost::signals2::keywords::mutex_type<Mutex>>::type;
+	using base_t::connect;
+	using mutex_type = Mutex;
+	using waiter_signature = void(Args...);
+
+	template <class Fn> using function_type = std::function<Fn>;
+
+	template <auto Fn, class Object>
+	auto connect(Object* object) { return extras_.get_or_create().batch.template connect<Fn>(object); }
+
+	template <class Object, class Fn>
+	auto connect(Object* object, Fn fn) { return extras_.get_or_create().batch.connect(object, fn); }
+
+	template <class Slot>
+	auto connect(independent_t, Slot && slot) { return extras_.get_or_create().parallel.connect(std::forward<Slot>(slot)); }
+
+	boost_signal_impl() = default;
+
+	boost_signal_impl(boost_signal_impl && rhs) noexcept
+		: base_t { std::move(rhs) }
+		, extras_ { std::move(rhs.extras_) }
+	{
+	}
+
+	auto flush() -> void {}
+
+	auto add_waiter(waiter<void(Args...)>* w) -> void { extras_.get_or_create().waiters.add(w); }
+
+	auto operator()(Args... args)
+	{
+		if constexpr (std::is_void_v<R>)
+		{
+			base_t::operator()(args...);
+			notify_extras(args...);
+		}
+		else
+		{
+			auto result { base_t::operator()(args...) };
+			notify_extras(args...);
+			return result;
+		}
+	}
+
+private:
+
+	auto notify_extras(Args... args) -> void
+	{
+		const auto extras { extras_.get() };
+
+		if (!extras) return;
+
+		extras->batch(args...);
+		extras->parallel(args...);
+		extras->waiters(args...);
+	}
+
+	// Everything besides plain slots shares one block, so that a signal
+	// which only has plain slots costs one pointer and one load.
+	struct extras
+	{
+		batch_slots<void(Args...), BatchMutex> batch;
+		parallel_slots<void(Args...), BatchMutex> parallel;
+		waiter_list<void(Args...), BatchMutex> waiters;
+	};
+
+	lazy_ptr<extras> extras_;
+};
+
+// Callable stored in a fixed inline buffer. Callables which don't fit are
+// rejected at compile time. The default size fits a std::function, so a
+// slot which is already type-erased can always be stored.
+template <class Signature, std::size_t Size = std::max(sizeof(void*) * 4, sizeof(std::function<Signature>))>
+class inplace_fn;
+
+template <class R, class... Args, std::size_t Size>
+class inplace_fn<R(Args...), Size>
+{
+public:
+
+	inplace_fn() = default;
+	inplace_fn(const inplace_fn& rhs) = delete;
+	inplace_fn& operator=(const inplace_fn& rhs) = delete;
+
+	template <class Fn, class = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, inplace_fn>>>
+	inplace_fn(Fn && fn)
+	{
+		using fn_t = std::decay_t<Fn>;
+
+		static_assert(sizeof(fn_t) <= Size, "slot is too large for inline storage");
+		static_assert(alignof(fn_t) <= alignof(std::max_align_t));
+		static_assert(std::is_nothrow_move_constructible_v<fn_t>);
+
+		new (&storage_) fn_t { std::forward<Fn>(fn) };
+		ops_ = &OPS<fn_t>;
+	}
+
+	// Moving destroys the source's callable, so the source is left empty.
+	inplace_fn(inplace_fn && rhs) noexcept
+		: ops_ { std::exchange(rhs.ops_, nullptr) }
+	{
+		if (ops_) ops_->move(&storage_, &rhs.storage_);
+	}
+
+	inplace_fn& operator=(inplace_fn && rhs) noexcept
+	{
+		if (&rhs == this) return *this;
+
+		reset();
+
+		ops_ = std::exchange(rhs.ops_, nullptr);
+
+		if (ops_) ops_->move(&storage_, &rhs.storage_);
+
+		return *this;
+	}
+
+	~inplace_fn()
+	{
+		reset();
+	}
+
+	auto reset() -> void
+	{
+		if (!ops_) return;
+
+		std::exchange(ops_, nullptr)->destroy(&storage_);
+	}
+
+	auto operator()(Args... args) const -> R { return ops_->call(&storage_, args...); }
+	explicit operator bool() const { return ops_; }
+
+private:
+
+	struct ops
+	{
+		R (*call)(void* fn, Args... args);
+		void (*move)(void* dst, void* src);
+		void (*destroy)(void* fn);
+	};
+
+	template <class Fn>
+	static constexpr ops OPS
+	{
+		[](void* fn, Args... args) -> R { return (*static_cast<Fn*>(fn))(args...); },
+		[](void* dst, void* src) { new (dst) Fn { std::move(*static_cast<Fn*>(src)) }; static_cast<Fn*>(src)->~Fn(); },
+		[](void* fn) { static_cast<Fn*>(fn)->~Fn(); },
+	};
+
+	alignas(std::max_align_t) mutable unsigned char storage_[Size];
+	const ops* ops_ {};
+};
+
+inline auto cpu_relax() -> void
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+// Spins on a plain load so waiting threads don't bounce the cache line,
+// then starts yielding its time slice if the holder takes too long.
+class spin_mutex
+{
+public:
+
+	auto lock() -> void
+	{
+		for (int spins = 0; !try_lock();)
+		{
+			while (locked_.load(std::memory_order_relaxed))
+			{
+				if (spins++ < MAX_SPINS)
+				{
+					cpu_relax();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	auto try_lock() -> bool
+	{
+		return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+	}
+
+	auto unlock() -> void
+	{
+		locked_.store(false, std::memory_order_release);
+	}
+
+private:
+
+	static constexpr int MAX_SPINS { 64 };
+
+	std::atomic<bool> locked_ { false };
+};
+
+template <class Threading> struct threading_traits;
+
+template <> struct threading_traits<threading::none>
+{
+	using mutex_type = boost::signals2::dummy_mutex;
+	using recursive_mutex_type = boost::signals2::dummy_mutex;
+};
+
+template <> struct threading_traits<threading::spinlock>
+{
+	using mutex_type = spin_mutex;
+	using recursive_mutex_type = std::recursive_mutex;
+};
+
+template <> struct threading_traits<threading::mutex>
+{
+	using mutex_type = boost::signals2::mutex;
+	using recursive_mutex_type = std::recursive_mutex;
+};
+
+template <> struct threading_traits<threading::lock_free>
+{
+	using mutex_type = spin_mutex;
+	using recursive_mutex_type = std::recursive_mutex;
+};
+
+template <class Signature>
+struct slot_entry
+{
+	inplace_fn<Signature> fn;
+	std::uint32_t id {};
+	intrusive_cn* cn {};
+	bool live {};
+};
+
+template <class Entry, std::size_t N, overflow_policy Overflow>
+class inline_slots
+{
+public:
+
+	static_assert(N > 0);
+
+	static constexpr auto STABLE { true };
+	static constexpr auto OVERFLOW_POLICY { Overflow };
+
+	inline_slots() = default;
+
+	inline_slots(inline_slots && rhs) noexcept
+		: size_ { rhs.size_ }
+	{
+		for (std::size_t i = 0; i < size_; i++) entries_[i] = std::move(rhs.entries_[i]);
+	}
+
+	auto full() const { return size_ == N; }
+	auto size() const { return size_; }
+	auto& operator[](std::size_t index) { return entries_[index]; }
+
+	auto push_back(Entry && entry) -> void
+	{
+		entries_[size_++] = std::move(entry);
+	}
+
+	auto erase(std::size_t index) -> void
+	{
+		for (auto i = index + 1; i < size_; i++) entries_[i - 1] = std::move(entries_[i]);
+
+		entries_[--size_] = {};
+	}
+
+	auto clear() -> void
+	{
+		for (std::size_t i = 0; i < size_; i++) entries_[i] = {};
+
+		size_ = 0;
+	}
+
+private:
+
+	std::array<Entry, N> entries_;
+	std::size_t size_ { 0 };
+};
+
+template <class Entry, std::size_t N>
+class small_vector_slots
+{
+public:
+
+	static constexpr auto STABLE { false };
+	static constexpr auto OVERFLOW_POLICY { overflow_policy::terminate };
+
+	auto full() const { return false; }
+	auto size() const { return entries_.size(); }
+	auto& operator[](std::size_t index) { return entries_[index]; }
+	auto push_back(Entry && entry) -> void { entries_.push_back(std::move(entry)); }
+	auto erase(std::size_t index) -> void { entries_.erase(entries_.begin() + index); }
+	auto clear() -> void { entries_.clear(); }
+
+private:
+
+	boost::container::small_vector<Entry, N> entries_;
+};
+
+// Slot list for signals which don't use boost. Container decides where the
+// slots live. Mutex guards the list but is never held while a slot runs:
+// slots disconnected during a notification are only marked dead and are
+// destroyed, outside the lock, once no notification is in progress. If the
+// container can relocate its slots, connections made during a
+// notification wait in a pending list until it finishes.
+template <class Signature, class Container, class Mutex>
+class slot_table;
+
+template <class... Args, class Container, class Mutex>
+class slot_table<void(Args...), Container, Mutex> : public slot_owner
+{
+public:
+
+	using mutex_type = Mutex;
+	using slot_type = std::function<void(Args...)>;
+	using waiter_signature = void(Args...);
+
+	template <class Fn> using function_type = inplace_fn<Fn>;
+
+	slot_table() = default;
+
+	slot_table(slot_table && rhs) noexcept
+		: slots_ { std::move(rhs.slots_) }
+		, pending_ { std::move(rhs.pending_) }
+		, next_id_ { rhs.next_id_ }
+		, dirty_ { rhs.dirty_ }
+		, waiters_ { std::move(rhs.waiters_) }
+	{
+		rhs.slots_.clear();
+		rhs.pending_.clear();
+
+		for_each_cn([this](intrusive_cn* cn) { reown(cn, this); });
+	}
+
+	~slot_table()
+	{
+		for_each_cn([](intrusive_cn* cn) { reown(cn, nullptr); });
+	}
+
+	template <class Slot>
+	auto connect(Slot && slot) -> intrusive_cn
+	{
+		entry_t entry { inplace_fn<void(Args...)> { std::forward<Slot>(slot) }, 0, nullptr, true };
+
+		if (slots_full()) collect();
+
+		std::uint32_t id;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			if (slots_.full())
+			{
+				if constexpr (Container::OVERFLOW_POLICY == overflow_policy::terminate) std::terminate();
+
+				return {};
+			}
+
+			entry.id = id = next_id_++;
+
+			if (!Container::STABLE && dispatching_ > 0)
+			{
+				pending_.push_back(std::move(entry));
+			}
+			else
+			{
+				slots_.push_back(std::move(entry));
+			}
+		}
+
+		return make_cn(this, id);
+	}
+
+	template <auto Fn, class Object>
+	auto connect(Object* object) -> intrusive_cn
+	{
+		return connect([object](Args... args) { call_delegate(Fn, object, args...); });
+	}
+
+	template <class Object, class Fn>
+	auto connect(Object* object, Fn fn) -> intrusive_cn
+	{
+		return connect([object, fn](Args... args) { call_delegate(fn, object, args...); });
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		std::size_t size;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			size = slots_.size();
+			dispatching_++;
+		}
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			if (is_live(i)) slots_[i].fn(args...);
+		}
+
+		bool clean;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			clean = --dispatching_ > 0 || (!dirty_ && pending_.empty());
+		}
+
+		if (!clean) collect();
+
+		if (const auto waiters { waiters_.get() }) (*waiters)(args...);
+	}
+
+	auto flush() -> void {}
+
+	auto add_waiter(waiter<void(Args...)>* w) -> void { waiters_.get_or_create().add(w); }
+
+	auto disconnect(std::uint32_t id) -> void override
+	{
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			const auto entry { find(id) };
+
+			if (!entry) return;
+
+			entry->live = false;
+			entry->cn = nullptr;
+			dirty_ = true;
+		}
+
+		collect();
+	}
+
+	auto rebind(std::uint32_t id, intrusive_cn* cn) -> void override
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		if (const auto entry { find(id) }) entry->cn = cn;
+	}
+
+private:
+
+	using entry_t = slot_entry<void(Args...)>;
+
+	auto slots_full() -> bool
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		return slots_.full();
+	}
+
+	auto is_live(std::size_t index) -> bool
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		return slots_[index].live;
+	}
+
+	auto find(std::uint32_t id) -> entry_t*
+	{
+		for (std::size_t i = 0; i < slots_.size(); i++)
+		{
+			if (slots_[i].live && slots_[i].id == id) return &slots_[i];
+		}
+
+		for (auto& entry : pending_)
+		{
+			if (entry.live && entry.id == id) return &entry;
+		}
+
+		return nullptr;
+	}
+
+	auto collect() -> void
+	{
+		inplace_fn<void(Args...)> trash;
+
+		for (;;)
+		{
+			trash.reset();
+
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			if (dispatching_ > 0) return;
+
+			for (auto& entry : pending_)
+			{
+				dirty_ |= !entry.live;
+				slots_.push_back(std::move(entry));
+			}
+
+			pending_.clear();
+
+			if (!dirty_) return;
+
+			std::size_t index { 0 };
+
+			while (index < slots_.size() && slots_[index].live) index++;
+
+			if (index == slots_.size())
+			{
+				dirty_ = false;
+				return;
+			}
+
+			trash = std::move(slots_[index].fn);
+			slots_.erase(index);
+		}
+	}
+
+	template <class Fn>
+	auto for_each_cn(Fn && fn) -> void
+	{
+		for (std::size_t i = 0; i < slots_.size(); i++)
+		{
+			if (slots_[i].cn) fn(slots_[i].cn);
+		}
+
+		for (const auto& entry : pending_)
+		{
+			if (entry.cn) fn(entry.cn);
+		}
+	}
+
+	Mutex mutex_;
+	Container slots_;
+	std::vector<entry_t> pending_;
+	std::uint32_t next_id_ { 0 };
+	int dispatching_ { 0 };
+	bool dirty_ { false };
+	lazy_ptr<waiter_list<void(Args...), Mutex>> waiters_;
+};
+
+// Inline slot list where connect, disconnect and notify are all lock-free.
+// Each slot has an atomic state word holding its phase and the number of
+// notifications currently running it; whichever thread takes a dead slot's
+// count to zero destroys it.
+template <class Signature, std::size_t N, overflow_policy Overflow>
+class lock_free_slot_table;
+
+template <class... Args, std::size_t N, overflow_policy Overflow>
+class lock_free_slot_table<void(Args...), N, Overflow> : public slot_owner
+{
+public:
+
+	static_assert(N > 0);
+
+	using mutex_type = spin_mutex;
+	using slot_type = std::function<void(Args...)>;
+	using waiter_signature = void(Args...);
+
+	template <class Fn> using function_type = inplace_fn<Fn>;
+
+	lock_free_slot_table() = default;
+
+	lock_free_slot_table(lock_free_slot_table && rhs) noexcept
+		: size_ { rhs.size_.load() }
+		, next_id_ { rhs.next_id_.load() }
+		, waiters_ { std::move(rhs.waiters_) }
+	{
+		for (std::size_t i = 0; i < N; i++)
+		{
+			auto& from { rhs.slots_[i] };
+			auto& to { slots_[i] };
+
+			if (from.state.load() != LIVE) continue;
+
+			to.fn = std::move(from.fn);
+			to.id.store(from.id.load());
+			to.cn.store(from.cn.load());
+			to.state.store(LIVE);
+			from.cn.store(nullptr);
+			from.state.store(FREE);
+
+			if (const auto cn { to.cn.load() }) reown(cn, this);
+		}
+	}
+
+	~lock_free_slot_table()
+	{
+		for (auto& slot : slots_)
+		{
+			if (const auto cn { slot.cn.load() }) reown(cn, nullptr);
+		}
+	}
+
+	template <class Slot>
+	auto connect(Slot && slot) -> intrusive_cn
+	{
+		for (std::size_t i = 0; i < N; i++)
+		{
+			auto& entry { slots_[i] };
+			auto state { FREE };
+
+			if (!entry.state.compare_exchange_strong(state, CLAIMED, std::memory_order_acquire)) continue;
+
+			const auto id { next_id_.fetch_add(1, std::memory_order_relaxed) };
+
+			entry.fn = inplace_fn<void(Args...)> { std::forward<Slot>(slot) };
+			entry.id.store(id, std::memory_order_relaxed);
+			entry.cn.store(nullptr, std::memory_order_relaxed);
+			entry.state.store(LIVE, std::memory_order_release);
+
+			auto size { size_.load(std::memory_order_relaxed) };
+
+			while (size < i + 1 && !size_.compare_exchange_weak(size, i + 1, std::memory_order_release)) {}
+
+			return make_cn(this, id);
+		}
+
+		if constexpr (Overflow == overflow_policy::terminate) std::terminate();
+
+		return {};
+	}
+
+	template <auto Fn, class Object>
+	auto connect(Object* object) -> intrusive_cn
+	{
+		return connect([object](Args... args) { call_delegate(Fn, object, args...); });
+	}
+
+	template <class Object, class Fn>
+	auto connect(Object* object, Fn fn) -> intrusive_cn
+	{
+		return connect([object, fn](Args... args) { call_delegate(fn, object, args...); });
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		const auto size { size_.load(std::memory_order_acquire) };
+		const auto end_id { next_id_.load(std::memory_order_acquire) };
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			auto& entry { slots_[i] };
+
+			if (!acquire(entry)) continue;
+
+			if (std::int32_t(entry.id.load(std::memory_order_relaxed) - end_id) < 0) entry.fn(args...);
+
+			release(entry);
+		}
+
+		if (const auto waiters { waiters_.get() }) (*waiters)(args...);
+	}
+
+	auto flush() -> void {}
+
+	auto add_waiter(waiter<void(Args...)>* w) -> void { waiters_.get_or_create().add(w); }
+
+	auto disconnect(std::uint32_t id) -> void override
+	{
+		const auto entry { find(id) };
+
+		if (!entry) return;
+
+		auto state { entry->state.load(std::memory_order_acquire) };
+
+		do
+		{
+			if ((state & PHASE) != LIVE) return;
+		}
+		while (!entry->state.compare_exchange_weak(state, DEAD | (state & COUNT), std::memory_order_acq_rel));
+
+		entry->cn.store(nullptr, std::memory_order_relaxed);
+
+		if ((state & COUNT) == 0) free(*entry);
+	}
+
+	auto rebind(std::uint32_t id, intrusive_cn* cn) -> void override
+	{
+		if (const auto entry { find(id) }) entry->cn.store(cn, std::memory_order_relaxed);
+	}
+
+private:
+
+	static constexpr std::uint32_t FREE { 0u << 30 };
+	static constexpr std::uint32_t CLAIMED { 1u << 30 };
+	static constexpr std::uint32_t LIVE { 2u << 30 };
+	static constexpr std::uint32_t DEAD { 3u << 30 };
+	static constexpr std::uint32_t PHASE { 3u << 30 };
+	static constexpr std::uint32_t COUNT { ~PHASE };
+
+	struct entry_t
+	{
+		std::atomic<std::uint32_t> state { FREE };
+		std::atomic<std::uint32_t> id { 0 };
+		std::atomic<intrusive_cn*> cn { nullptr };
+		inplace_fn<void(Args...)> fn;
+	};
+
+	static auto acquire(entry_t& entry) -> bool
+	{
+		auto state { entry.state.load(std::memory_order_relaxed) };
+
+		do
+		{
+			if ((state & PHASE) != LIVE) return false;
+		}
+		while (!entry.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+		return true;
+	}
+
+	static auto release(entry_t& entry) -> void
+	{
+		if (entry.state.fetch_sub(1, std::memory_order_acq_rel) == (DEAD | 1)) free(entry);
+	}
+
+	static auto free(entry_t& entry) -> void
+	{
+		entry.fn.reset();
+		entry.state.store(FREE, std::memory_order_release);
+	}
+
+	auto find(std::uint32_t id) -> entry_t*
+	{
+		const auto size { size_.load(std::memory_order_acquire) };
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			auto& entry { slots_[i] };
+
+			if ((entry.state.load(std::memory_order_acquire) & PHASE) != LIVE) continue;
+			if (entry.id.load(std::memory_order_relaxed) == id) return &entry;
+		}
+
+		return nullptr;
+	}
+
+	std::array<entry_t, N> slots_;
+	std::atomic<std::size_t> size_ { 0 };
+	std::atomic<std::uint32_t> next_id_ { 0 };
+	lazy_ptr<waiter_list<void(Args...), spin_mutex>> waiters_;
+};
+
+// Wraps a slot list so that notifying only records the arguments. The
+// recorded notifications are delivered, in order, by flush().
+template <class Impl, class Signature, class Mutex>
+class queued_signal;
+
+template <class Impl, class... Args, class Mutex>
+class queued_signal<Impl, void(Args...), Mutex> : public Impl
+{
+public:
+
+	queued_signal() = default;
+
+	queued_signal(queued_signal && rhs) noexcept
+		: Impl { std::move(rhs) }
+		, queue_ { std::move(rhs.queue_) }
+	{
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		std::lock_guard<Mutex> lock { mutex_ };
+
+		queue_.emplace_back(args...);
+	}
+
+	auto flush() -> void
+	{
+		std::vector<std::tuple<std::decay_t<Args>...>> queue;
+
+		{
+			std::lock_guard<Mutex> lock { mutex_ };
+
+			queue.swap(queue_);
+		}
+
+		for (auto& args : queue)
+		{
+			std::apply([this](auto&... args) { Impl::operator()(args...); }, args);
+		}
+	}
+
+private:
+
+	Mutex mutex_;
+	std::vector<std::tuple<std::decay_t<Args>...>> queue_;
+};
+
+// Per-thread FIFO of notifications raised while another notification on
+// the same thread was being delivered.
+class cascade_queue
+{
+public:
+
+	struct entry
+	{
+		const void* owner;
+		std::function<void()> fn;
+	};
+
+	static auto get() -> cascade_queue&
+	{
+		thread_local cascade_queue queue;
+
+		return queue;
+	}
+
+	auto forget(const void* owner) -> void
+	{
+		for (auto& entry : entries)
+		{
+			if (entry.owner == owner) entry.fn = nullptr;
+		}
+	}
+
+	std::deque<entry> entries;
+	bool active { false };
+};
+
+// Notifying from inside a slot doesn't recurse. The notification is
+// appended to the thread's cascade queue instead, and the outermost
+// notification on the thread delivers the queue in order before it
+// returns, so stack depth stays constant however long the chain of
+// slots setting properties gets. A notification without arguments which
+// is already waiting in the queue is not queued a second time.
+template <class Impl, class Signature>
+class fifo_signal;
+
+template <class Impl, class... Args>
+class fifo_signal<Impl, void(Args...)> : public Impl
+{
+public:
+
+	fifo_signal() = default;
+	fifo_signal(fifo_signal && rhs) noexcept : Impl { std::move(rhs) } {}
+
+	~fifo_signal()
+	{
+		auto& queue { cascade_queue::get() };
+
+		if (!queue.entries.empty()) queue.forget(this);
+	}
+
+	auto operator()(Args... args) -> void
+	{
+		auto& queue { cascade_queue::get() };
+
+		if (queue.active)
+		{
+			if constexpr (sizeof...(Args) == 0)
+			{
+				if (pending_.exchange(true, std::memory_order_relaxed)) return;
+
+				queue.entries.push_back({ this, [this]()
+				{
+					pending_.store(false, std::memory_order_relaxed);
+					Impl::operator()();
+				}});
+			}
+			else
+			{
+				queue.entries.push_back({ this, [this, args = std::make_tuple(std::decay_t<Args> { args }...)]()
+				{
+					std::apply([this](const auto&... args) { Impl::operator()(args...); }, args);
+				}});
+			}
+
+			return;
+		}
+
+		struct scope
+		{
+			scope(cascade_queue& queue) : queue { queue } { queue.active = true; }
+			~scope() { queue.active = false; }
+
+			cascade_queue& queue;
+		};
+
+		scope scope { queue };
+
+		Impl::operator()(args...);
+
+		while (!queue.entries.empty())
+		{
+			const auto entry { std::move(queue.entries.front()) };
+
+			queue.entries.pop_front();
+
+			if (entry.fn) entry.fn();
+		}
+	}
+
+private:
+
+	std::atomic<bool> pending_ { false };
+};
+
+template <class Signature, class Threading, class Storage>
+struct select_storage;
+
+template <class Signature, class Threading>
+struct select_storage<Signature, Threading, storage::heap>
+{
+	static_assert(!std::is_same_v<Threading, threading::lock_free>, "lock-free threading requires inline storage");
+
+	using type = boost_signal_impl<Signature, typename threading_traits<Threading>::mutex_type, typename threading_traits<Threading>::recursive_mutex_type>;
+};
+
+template <class Signature, class Threading, std::size_t N>
+struct select_storage<Signature, Threading, storage::small_vector<N>>
+{
+	static_assert(!std::is_same_v<Threading, threading::lock_free>, "lock-free threading requires inline storage");
+
+	using type = slot_table<Signature, small_vector_slots<slot_entry<Signature>, N>, typename threading_traits<Threading>::mutex_type>;
+};
+
+template <class Signature, class Threading, std::size_t N, overflow_policy Overflow>
+struct select_storage<Signature, Threading, storage::inline_n<N, Overflow>>
+{
+	using type = std::conditional_t<std::is_same_v<Threading, threading::lock_free>,
+		lock_free_slot_table<Signature, N, Overflow>,
+		slot_table<Signature, inline_slots<slot_entry<Signature>, N, Overflow>, typename threading_traits<Threading>::mutex_type>>;
+};
+
+template <class Impl, class Signature, class Threading, class Dispatch>
+struct select_dispatch;
+
+template <class Impl, class Signature, class Threading>
+struct select_dispatch<Impl, Signature, Threading, dispatch::sync>
+{
+	using type = Impl;
+};
+
+template <class Impl, class Signature, class Threading>
+struct select_dispatch<Impl, Signature, Threading, dispatch::queued>
+{
+	using type = queued_signal<Impl, Signature, typename threading_traits<Threading>::mutex_type>;
+};
+
+template <class Impl, class Signature, class Threading>
+struct select_dispatch<Impl, Signature, Threading, dispatch::fifo>
+{
+	using type = fifo_signal<Impl, Signature>;
+};
+
+template <class Signature, class Threading, class Storage, class Dispatch>
+using basic_signal_impl = typename select_dispatch<typename select_storage<Signature, Threading, Storage>::type, Signature, Threading, Dispatch>::type;
+
+template <class T>
+using boost_signal = basic_signal_impl<T, threading::none, storage::heap, dispatch::sync>;
+
+template <class T>
+using boost_mt_signal = basic_signal_impl<T, threading::mutex, storage::heap, dispatch::sync>;
+
+// Counts value changes so that other threads can block until one happens,
+// and guards the value so that a waiting thread can take a consistent copy
+// of it. Untimed waits sleep on the counter itself where std::atomic::wait
+// is available; timed waits, and untimed ones elsewhere, use a condition
+// variable which is only allocated when somebody first sleeps on it and
+// which a change only touches if somebody is sleeping.
+template <class Mutex>
+class change_version
+{
+public:
+
+	change_version() = default;
+	change_version(change_version && rhs) noexcept : version_ { rhs.version_.load() } {}
+
+	auto load() const { return version_.load(std::memory_order_acquire); }
+
+	template <class Fn>
+	auto write(Fn && fn)
+	{
+		std::lock_guard<spin_mutex> lock { guard_ };
+
+		return fn();
+	}
+
+	template <class Fn>
+	auto read(Fn && fn) const
+	{
+		std::lock_guard<spin_mutex> lock { guard_ };
+
+		return fn();
+	}
+
+	auto bump() -> void
+	{
+		version_.fetch_add(1, std::memory_order_seq_cst);
+
+#if defined(__cpp_lib_atomic_wait)
+		version_.notify_all();
+#endif
+
+		if (sleepers_.load(std::memory_order_seq_cst) == 0) return;
+
+		auto& sleep { *sleep_.get() };
+
+		std::lock_guard<std::mutex> lock { sleep.mutex };
+
+		sleep.cv.notify_all();
+	}
+
+	auto wait(std::uint32_t old) const -> void
+	{
+#if defined(__cpp_lib_atomic_wait)
+		version_.wait(old, std::memory_order_acquire);
+#else
+		wait_for(old, std::chrono::steady_clock::duration::max());
+#endif
+	}
+
+	template <class Rep, class Period>
+	auto wait_for(std::uint32_t old, std::chrono::duration<Rep, Period> timeout) const -> bool
+	{
+		const auto changed { [this, old] { return version_.load(std::memory_order_seq_cst) != old; } };
+
+		if (changed()) return true;
+
+		auto& sleep { sleep_.get_or_create() };
+
+		std::unique_lock<std::mutex> lock { sleep.mutex };
+
+		sleepers_.fetch_add(1, std::memory_order_seq_cst);
+
+		const auto result { wait_cv(sleep.cv, lock, timeout, changed) };
+
+		sleepers_.fetch_sub(1, std::memory_order_relaxed);
+
+		return result;
+	}
+
+private:
+
+	struct sleep_state
+	{
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+
+	template <class Rep, class Period, class Pred>
+	static auto wait_cv(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, std::chrono::duration<Rep, Period> timeout, Pred pred) -> bool
+	{
+		if (timeout == std::chrono::duration<Rep, Period>::max())
+		{
+			cv.wait(lock, pred);
+			return true;
+		}
+
+		return cv.wait_for(lock, timeout, pred);
+	}
+
+	std::atomic<std::uint32_t> version_ { 0 };
+	mutable std::atomic<std::uint32_t> sleepers_ { 0 };
+	mutable spin_mutex guard_;
+	mutable lazy_ptr<sleep_state> sleep_;
+};
+
+// Nothing can wait on a single threaded property.
+template <>
+class change_version<boost::signals2::dummy_mutex>
+{
+public:
+
+	template <class Fn>
+	auto write(Fn && fn) { return fn(); }
+
+	template <class Fn>
+	auto read(Fn && fn) const { return fn(); }
+
+	auto bump() -> void {}
+};
+
+} // detail
+
+class store
+{
+public:
+
+	auto operator+=(scoped_cn && c) -> void
+	{
+		connections_.push_back(std::move(c));
+	}
+
+	auto operator+=(intrusive_cn && c) -> void
+	{
+		intrusive_connections_.push_back(std::move(c));
+	}
+
+private:
+
+	std::vector<scoped_cn> connections_;
+	std::vector<intrusive_cn> intrusive_connections_;
+};
+
+template <class Observer>
+class value_cn
+{
+public:
+
+	using slot_t = std::function<void()>;
+
+	value_cn() = default;
+	value_cn(const value_cn& rhs) = default;
+	value_cn(value_cn && rhs) = default;
+	value_cn& operator=(const value_cn& rhs) = default;
+	value_cn& operator=(value_cn && rhs) = default;
+
+	value_cn(Observer observer, slot_t slot, bool start_disconnected = false)
+		: observer_ { observer }
+		, slot_ { slot }
+	{
+		if (!start_disconnected) connect();
+	}
+
+	auto connect()
+	{
+		connection_ = observer_.observe(slot_);
+	}
+
+	auto disconnect()
+	{
+		connection_.disconnect();
+	}
+
+	auto slot() const { slot_(); }
+	auto get() const { return observer_.get(); }
+	auto operator*() const { return get(); }
+
+private:
+
+	// Observers of signals which store their own slots hand out
+	// intrusive_cn, which is already scoped.
+	using connection_t = std::conditional_t<std::is_same_v<typename Observer::connection_t, intrusive_cn>, intrusive_cn, scoped_cn>;
+
+	Observer observer_;
+	slot_t slot_;
+	connection_t connection_;
+};
+
+// Connection is what observing the property returns, and Slot what its
+// signal's connect() takes: a boost connection and slot unless the
+// property stores its own slots.
+template <class T, class Connection = cn, class Slot = slot<void()>>
+class property_observer
+{
+public:
+
+	using connection_t = Connection;
+	using connector_t = std::function<Connection(Slot)>;
+
+	property_observer() = default;
+	property_observer(const property_observer& rhs) = default;
+	property_observer(property_observer && rhs) = default;
+	property_observer& operator=(const property_observer& rhs) = default;
+	property_observer& operator=(property_observer && rhs) = default;
+
+	property_observer(const T* value, connector_t connector)
+		: value_ { value }
+		, connector_ { connector }
+	{}
+
+	auto get() const { return *value_; }
+	auto operator*() const { return get(); }
+
+	template <typename Slot_>
+	auto observe(Slot_ && slot) { return connector_(std::forward<Slot_>(slot)); }
+
+	template <typename Slot_>
+	auto operator>>(Slot_ && slot) { return observe(std::forward<Slot_>(slot)); }
+
+private:
+
+	const T* value_ {};
+	connector_t connector_;
+};
+
+template <class T, class Connection = cn, class Slot = slot<void()>>
+class getter_observer
+{
+public:
+
+	using connection_t = Connection;
+	using getter_t = std::function<T()>;
+	using connector_t = std::function<Connection(Slot)>;
+
+	getter_observer() = default;
+	getter_observer(const getter_observer& rhs) = default;
+	getter_observer(getter_observer && rhs) = default;
+	getter_observer& operator=(const getter_observer& rhs) = default;
+	getter_observer& operator=(getter_observer && rhs) = default;
+
+	getter_observer(getter_t getter, connector_t connector)
+		: getter_ { getter }
+		, connector_ { connector }
+	{
+	}
+
+	auto get() const { return getter_(); }
+	auto operator()() const { return get(); }
+	operator bool() const { return bool(getter_); }
+
+	template <typename Slot_>
+	auto observe(Slot_ && slot) { return connector_(std::forward<Slot_>(slot)); }
+
+	template <typename Slot_>
+	auto operator>>(Slot_ && slot) { return observe(std::forward<Slot_>(slot)); }
+
+private:
+
+	getter_t getter_;
+	connector_t connector_;
+};
+
+template <class T, class Connection = cn, class Slot = slot<void()>> using property_cn = value_cn<property_observer<T, Connection, Slot>>;
+template <class T, class Connection = cn, class Slot = slot<void()>> using getter_cn = value_cn<getter_observer<T, Connection, Slot>>;
+
+namespace detail {
+
+using tracked_cn = std::variant<std::monostate, scoped_cn, intrusive_cn>;
+
+inline auto make_tracked_cn(cn && c) -> tracked_cn { return scoped_cn { std::move(c) }; }
+inline auto make_tracked_cn(intrusive_cn && c) -> tracked_cn { return std::move(c); }
+
+// Whatever is being evaluated on this thread and wants to know which
+// properties and getters it reads. Every get() reports to it.
+class dependency_tracker
+{
+public:
+
+	using connect_fn = tracked_cn(*)(const void* source, dependency_tracker* tracker);
+
+	static auto current() -> dependency_tracker*&
+	{
+		thread_local dependency_tracker* tracker { nullptr };
+
+		return tracker;
+	}
+
+	virtual auto depend(const void* source, connect_fn connect) -> void = 0;
+	virtual auto invalidate() -> void = 0;
+
+protected:
+
+	~dependency_tracker() = default;
+};
+
+template <class Source, class = void>
+struct has_observe_dependency : std::false_type {};
+
+template <class Source>
+struct has_observe_dependency<Source, std::void_t<decltype(std::declval<Source&>().observe_dependency(std::declval<void(*)()>()))>> : std::true_type {};
+
+template <class Source>
+auto tracked_read(const Source* source) -> void
+{
+	const auto tracker { dependency_tracker::current() };
+
+	if (!tracker) return;
+
+	tracker->depend(source, [](const void* source, dependency_tracker* tracker)
+	{
+		const auto observable { const_cast<Source*>(static_cast<const Source*>(source)) };
+		const auto invalidate { [tracker] { tracker->invalidate(); } };
+
+		if constexpr (has_observe_dependency<Source>::value) return make_tracked_cn(observable->observe_dependency(invalidate));
+		else return make_tracked_cn(observable->observe(invalidate));
+	});
+}
+
+class recompute_scheduler;
+
+// Tracking getter as seen by a recompute_scheduler.
+class recompute_node : public dependency_tracker
+{
+public:
+
+	virtual auto refresh() -> void = 0;
+	virtual auto connect_dependencies() -> void = 0;
+	virtual auto notify() -> void = 0;
+	virtual auto for_each_dependency(const std::function<void(const void*)>& fn) const -> void = 0;
+
+protected:
+
+	~recompute_node();
+
+	// Set while a scheduler is refreshing nodes on worker threads. Nodes
+	// refreshed then leave connecting to their new dependencies to the
+	// scheduler, which does it back on the owning thread.
+	class connect_queue
+	{
+	public:
+
+		auto add(recompute_node* node) -> void
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+
+			nodes_.push_back(node);
+		}
+
+		auto connect() -> void
+		{
+			for (const auto node : nodes_) node->connect_dependencies();
+
+			nodes_.clear();
+		}
+
+	private:
+
+		std::mutex mutex_;
+		std::vector<recompute_node*> nodes_;
+	};
+
+	static auto deferred_connects() -> connect_queue*&
+	{
+		thread_local connect_queue* queue { nullptr };
+
+		return queue;
+	}
+
+	auto defer_notify() -> bool;
+
+	friend class recompute_scheduler;
+
+	recompute_scheduler* scheduler_ {};
+	const void* key_ {};
+	bool queued_ { false };
+};
+
+template <class T, class SignalType>
+class read_only_property_base;
+
+template <class T, class SignalType>
+class property_setter_base
+{
+public:
+
+	property_setter_base(property_setter_base && rhs) = default;
+
+	property_setter_base(read_only_property_base<T, SignalType>* property)
+		: property_{ property }
+	{
+	}
+
+	template <class U>
+	auto& operator=(U && value)
+	{
+		set(std::forward<U>(value));
+
+		return *this;
+	}
+
+	template <class U>
+	auto set(U && value, bool notify = true, bool force = false) -> void
+	{
+		property_->set(std::forward<U>(value), notify, force);
+	}
+
+private:
+
+	read_only_property_base<T, SignalType>* property_;
+};
+
+template <class T, class SignalType>
+class read_only_property_base
+{
+public:
+
+	read_only_property_base() : value_ {} {}
+	read_only_property_base(T value) : value_ { value } {}
+	read_only_property_base(read_only_property_base<T, SignalType> && rhs) = default;
+
+	bool operator==(const T& value) const { return value_ == value; }
+
+	auto notify() -> void
+	{
+		signal_();
+
+		const auto list { value_signals_.get() };
+
+		if (!list) return;
+
+		// Another thread can be setting the value while this one notifies.
+		const auto now { copy() };
+
+		SignalType* target {};
+
+		{
+			std::lock_guard<typename SignalType::mutex_type> lock { list->mutex };
+
+			// Forced sets and explicit notifications don't count as becoming
+			// the value the property already had.
+			if (list->announced == now) return;
+
+			list->announced = now;
+
+			for (const auto& [value, signal] : list->signals)
+			{
+				if (value == now) { target = signal.get(); break; }
+			}
+		}
+
+		// Connecting from the slot adds to the list, so the slot runs after
+		// the lock is released.
+		if (target) (*target)();
+	}
+
+	auto flush() -> void
+	{
+		signal_.flush();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto observe(independent_t, Slot && slot) { return signal_.connect(independent, std::forward<Slot>(slot)); }
+
+	template <typename U, typename Slot>
+	auto observe(value_key<U> key, Slot && slot) { return value_signal(key.value).connect(std::forward<Slot>(slot)); }
+
+	// The filter is stored in the same slot and runs first, so the slot
+	// itself is only entered when the filter passes.
+	template <typename Slot, typename Filter, typename = std::enable_if_t<std::is_invocable_r_v<bool, Filter&, const T&, const T&>>>
+	auto observe(Slot && slot, Filter filter)
+	{
+		return signal_.connect(filtered_slot<std::decay_t<Slot>, Filter> { this, std::forward<Slot>(slot), std::move(filter) });
+	}
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	auto observer()
+	{
+		using slot_t = typename SignalType::slot_type;
+		using connection_t = decltype(std::declval<SignalType&>().connect(std::declval<slot_t>()));
+
+		const auto connect { [this](slot_t slot)
+		{
+			return signal_.connect(std::move(slot));
+		}};
+
+		return property_observer<T, connection_t, slot_t> { &value_, connect };
+	}
+
+	auto& get() const { tracked_read(this); return value_; }
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &get(); }
+
+	// Blocks the calling thread until the value changes.
+	auto wait_for_change() const -> void
+	{
+		version_.wait(version_.load());
+	}
+
+	// Returns false if the timeout expired first.
+	template <class Rep, class Period>
+	auto wait_for_change(std::chrono::duration<Rep, Period> timeout) const -> bool
+	{
+		return version_.wait_for(version_.load(), timeout);
+	}
+
+	// Blocks the calling thread until pred(value) holds. pred is called on
+	// a copy of the value, so it can't race with the thread setting it.
+	template <class Pred>
+	auto wait_until(Pred && pred) const -> void
+	{
+		for (;;)
+		{
+			const auto version { version_.load() };
+			const auto value { copy() };
+
+			if (pred(value)) return;
+
+			version_.wait(version);
+		}
+	}
+
+	// Returns false if the timeout expired before pred(value) held.
+	template <class Pred, class Rep, class Period>
+	auto wait_until(Pred && pred, std::chrono::duration<Rep, Period> timeout) const -> bool
+	{
+		const auto deadline { std::chrono::steady_clock::now() + timeout };
+
+		for (;;)
+		{
+			const auto version { version_.load() };
+			const auto value { copy() };
+
+			if (pred(value)) return true;
+
+			const auto remaining { deadline - std::chrono::steady_clock::now() };
+
+			if (remaining <= remaining.zero() || !version_.wait_for(version, remaining))
+			{
+				const auto last { copy() };
+
+				return pred(last);
+			}
+		}
+	}
+
+#if V_COROUTINES
+	auto changed() { return value_awaiter { signal_, *this, nullptr }; }
+
+	template <class Pred>
+	auto until(Pred && pred) { return value_awaiter { signal_, *this, std::forward<Pred>(pred) }; }
+#endif
+
+private:
+
+	template <class U>
+	auto& operator=(U && value)
+	{
+		set(std::forward<U>(value));
+
+		return *this;
+	}
+
+	template <class U>
+	auto set(U && value, bool notify = true, bool force = false) -> void
+	{
+		// Compared under the guard, since another thread may be setting it.
+		const auto changed { version_.write([&]
+		{
+			if (value == value_ && !force) return false;
+
+			value_ = std::forward<U>(value);
+
+			return true;
+		}) };
+
+		if (!changed) return;
+
+		version_.bump();
+
+		if (notify) this->notify();
+	}
+
+	auto copy() const -> T { return version_.read([this] { return value_; }); }
+
+#if V_COROUTINES
+	template <class, class, class> friend class value_awaiter;
+#endif
+
+	template <class U>
+	auto value_signal(const U& value) -> SignalType&
+	{
+		auto& list { value_signals_.get_or_create() };
+
+		std::lock_guard<typename SignalType::mutex_type> lock { list.mutex };
+
+		if (!list.announced) list.announced = copy();
+
+		for (const auto& [key, signal] : list.signals)
+		{
+			if (key == value) return *signal;
+		}
+
+		list.signals.emplace_back(value, std::make_unique<SignalType>());
+
+		return *list.signals.back().second;
+	}
+
+	// Slot for observe(slot, filter). Notifications from different threads
+	// take turns to compare against and update last, so each sees the
+	// value the one before it left.
+	template <class Slot, class Filter>
+	class filtered_slot
+	{
+	public:
+
+		using mutex_type = std::conditional_t<std::is_same_v<typename SignalType::mutex_type, boost::signals2::dummy_mutex>, boost::signals2::dummy_mutex, spin_mutex>;
+
+		template <class S>
+		filtered_slot(const read_only_property_base* property, S && slot, Filter filter)
+			: property_ { property }
+			, slot_ { std::forward<S>(slot) }
+			, filter_ { std::move(filter) }
+			, last_ { property->copy() }
+		{
+		}
+
+		filtered_slot(const filtered_slot& rhs)
+			: property_ { rhs.property_ }
+			, slot_ { rhs.slot_ }
+			, filter_ { rhs.filter_ }
+			, last_ { rhs.last_ }
+		{
+		}
+
+		filtered_slot(filtered_slot && rhs) noexcept(std::is_nothrow_move_constructible_v<Slot> && std::is_nothrow_move_constructible_v<Filter> && std::is_nothrow_move_constructible_v<T>)
+			: property_ { rhs.property_ }
+			, slot_ { std::move(rhs.slot_) }
+			, filter_ { std::move(rhs.filter_) }
+			, last_ { std::move(rhs.last_) }
+		{
+		}
+
+		auto operator()() -> void
+		{
+			bool pass;
+
+			{
+				std::lock_guard<mutex_type> lock { mutex_ };
+
+				auto now { property_->copy() };
+
+				pass = filter_(std::as_const(last_), std::as_const(now));
+				last_ = std::move(now);
+			}
+
+			// The slot may set the property again, which runs this slot.
+			if (pass) slot_();
+		}
+
+	private:
+
+		const read_only_property_base* property_;
+		Slot slot_;
+		Filter filter_;
+		T last_;
+		mutex_type mutex_;
+	};
+
+	// Signals for observe(becomes(x)). announced is the value as of the
+	// last notification, so each signal only runs when the value changes
+	// to its key.
+	struct value_signal_list
+	{
+		typename SignalType::mutex_type mutex;
+		std::vector<std::pair<T, std::unique_ptr<SignalType>>> signals;
+		std::optional<T> announced;
+	};
+
+	friend class property_setter_base<T, SignalType>;
+
+	// version_ is empty for single threaded properties, so it goes where
+	// it can fill the padding after a small value.
+	T value_;
+	change_version<typename SignalType::mutex_type> version_;
+	SignalType signal_;
+	lazy_ptr<value_signal_list> value_signals_;
+};
+
+template <class T, class SignalType>
+class property_base : public read_only_property_base<T, SignalType>
+{
+public:
+
+	property_base()
+		: setter_{ this }
+	{
+	}
+
+	property_base(const T & value)
+		: read_only_property_base<T, SignalType> { value }
+		, setter_{ this }
+	{
+	}
+
+	property_base(property_base && rhs)
+		: read_only_property_base<T, SignalType> { std::move(rhs) }
+		, setter_{ this }
+	{
+	}
+
+	template <class U>
+	auto& operator=(U && value)
+	{
+		setter_.operator=(std::forward<U>(value));
+
+		return *this;
+	}
+
+	auto set(const T& value, bool notify = true, bool force = false) -> void
+	{
+		setter_.set(value, notify, force);
+	}
+
+private:
+
+	property_setter_base<T, SignalType> setter_;
+};
+
+template <class T, class SignalType>
+class one_shot_property_base : public property_base<T, SignalType>
+{
+public:
+
+	one_shot_property_base(const T & value)
+		: property_base<T, SignalType> { value }
+	{
+	}
+
+	template <class U>
+	auto& operator=(U && value)
+	{
+		if (flag_) return *this;
 
 		property_base<T, SignalType>::operator=(std::forward<U>(value));
 
-		flag_ = true;
+		flag_ = true;
+
+		return *this;
+	}
+
+	auto set(const T& value, bool notify = true, bool force = false) -> void
+	{
+		if (flag_) return;
+
+		property_base<T, SignalType>::set(value, notify, force);
+
+		flag_ = true;
+	}
+
+private:
+
+	bool flag_{ false };
+};
+
+template <class T, class SignalType>
+class getter_base
+{
+public:
+
+	using getter_fn = typename SignalType::template function_type<T()>;
+
+	getter_base() = default;
+	getter_base(getter_fn getter) : getter_ { std::move(getter) } {}
+
+	auto notify() -> void
+	{
+		signal_();
+	}
+
+	auto flush() -> void
+	{
+		signal_.flush();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto observe(independent_t, Slot && slot) { return signal_.connect(independent, std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	// Where the getter is stored inline the observer calls it through this
+	// getter rather than copying it.
+	auto observer()
+	{
+		using slot_t = typename SignalType::slot_type;
+		using connection_t = decltype(std::declval<SignalType&>().connect(std::declval<slot_t>()));
+
+		const auto connect { [this](slot_t slot)
+		{
+			return signal_.connect(std::move(slot));
+		}};
+
+		if constexpr (std::is_copy_constructible_v<getter_fn>) return getter_observer<T, connection_t, slot_t> { getter_, connect };
+		else return getter_observer<T, connection_t, slot_t> { [this] { return getter_(); }, connect };
+	}
+
+	auto set(getter_fn getter) { getter_ = std::move(getter); }
+	auto get() const { tracked_read(this); return getter_(); }
+	auto operator()() const { return get(); }
+	auto operator*() const { return get(); }
+
+#if V_COROUTINES
+	auto changed() { return value_awaiter { signal_, *this, nullptr }; }
+
+	template <class Pred>
+	auto until(Pred && pred) { return value_awaiter { signal_, *this, std::forward<Pred>(pred) }; }
+#endif
+
+private:
+
+	auto copy() const -> T { return getter_(); }
+
+#if V_COROUTINES
+	template <class, class, class> friend class value_awaiter;
+#endif
+
+	getter_fn getter_;
+	SignalType signal_;
+};
+
+// Getter which works out its own dependencies. Every property and getter
+// read while the function runs is recorded and observed; the dependency
+// set is rebuilt on each evaluation, so reads which stop happening are
+// unsubscribed. A change to any dependency marks the value stale and
+// notifies observers; the function only runs again on the next get().
+// Attached to a recompute_scheduler, the observers are instead notified
+// once the scheduler has brought the value up to date.
+template <class T, class SignalType>
+class tracking_getter_base : public recompute_node
+{
+public:
+
+	using getter_fn = std::function<T()>;
+
+	tracking_getter_base(getter_fn getter) : getter_ { std::move(getter) } {}
+	tracking_getter_base(const tracking_getter_base& rhs) = delete;
+	tracking_getter_base& operator=(const tracking_getter_base& rhs) = delete;
+
+	auto notify() -> void override
+	{
+		signal_();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	// Used by other tracking getters which read this one.
+	template <typename Slot>
+	auto observe_dependency(Slot && slot) { return dependents_.connect(std::forward<Slot>(slot)); }
+
+	auto get() const -> const T&
+	{
+		tracked_read(this);
+
+		const_cast<tracking_getter_base*>(this)->refresh();
+
+		return *value_;
+	}
+
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &get(); }
+
+	auto dependency_count() const { return dependencies_.size(); }
+
+private:
+
+	struct dependency
+	{
+		const void* source;
+		connect_fn connect;
+		tracked_cn cn;
+		bool seen;
+	};
+
+	struct scope
+	{
+		scope(dependency_tracker* tracker) : outer { std::exchange(current(), tracker) } {}
+		~scope() { current() = outer; }
+
+		dependency_tracker* outer;
+	};
+
+	auto refresh() -> void override
+	{
+		if (!stale_.load(std::memory_order_acquire)) return;
+
+		std::lock_guard<spin_mutex> lock { mutex_ };
+
+		if (!stale_.load(std::memory_order_relaxed)) return;
+
+		for (auto& dependency : dependencies_) dependency.seen = false;
+
+		{
+			scope scope { this };
+
+			value_.emplace(getter_());
+		}
+
+		const auto unseen { [](const dependency& dependency) { return !dependency.seen; } };
+
+		dependencies_.erase(std::remove_if(dependencies_.begin(), dependencies_.end(), unseen), dependencies_.end());
+
+		if (const auto deferred { deferred_connects() }) deferred->add(this);
+		else connect_dependencies();
+
+		stale_.store(false, std::memory_order_release);
+	}
+
+	auto connect_dependencies() -> void override
+	{
+		for (auto& dependency : dependencies_)
+		{
+			if (std::holds_alternative<std::monostate>(dependency.cn)) dependency.cn = dependency.connect(dependency.source, this);
+		}
+	}
+
+	auto for_each_dependency(const std::function<void(const void*)>& fn) const -> void override
+	{
+		for (const auto& dependency : dependencies_) fn(dependency.source);
+	}
+
+	auto depend(const void* source, connect_fn connect) -> void override
+	{
+		for (auto& dependency : dependencies_)
+		{
+			if (dependency.source != source) continue;
+
+			dependency.seen = true;
+			return;
+		}
+
+		dependencies_.push_back({ source, connect, {}, true });
+	}
+
+	auto invalidate() -> void override
+	{
+		stale_.store(true, std::memory_order_release);
+		dependents_();
+
+		if (!defer_notify()) notify();
+	}
+
+	getter_fn getter_;
+	std::optional<T> value_;
+	std::vector<dependency> dependencies_;
+	std::atomic<bool> stale_ { true };
+	spin_mutex mutex_;
+	SignalType dependents_;
+	SignalType signal_;
+};
+
+// Brings stale tracking getters up to date on a thread pool. Once added,
+// a getter no longer notifies its observers as soon as a dependency
+// changes. run() refreshes every stale getter, level by level so that a
+// getter only runs once the getters it reads are done, with the getters
+// within a level running in parallel. It then notifies observers on the
+// calling thread in the order the getters were added. Dependencies must
+// not change while run() is in progress.
+class recompute_scheduler
+{
+public:
+
+	recompute_scheduler(thread_pool& pool = thread_pool::shared()) : pool_ { &pool } {}
+	recompute_scheduler(const recompute_scheduler& rhs) = delete;
+	recompute_scheduler& operator=(const recompute_scheduler& rhs) = delete;
+
+	~recompute_scheduler()
+	{
+		for (const auto node : nodes_) node->scheduler_ = nullptr;
+	}
+
+	template <class Getter>
+	auto add(Getter& getter) -> void
+	{
+		recompute_node* node { &getter };
+
+		static_assert(std::is_base_of_v<recompute_node, Getter>);
+
+		node->scheduler_ = this;
+		node->key_ = static_cast<const void*>(&getter);
+		index_[node->key_] = nodes_.size();
+		nodes_.push_back(node);
+	}
+
+	auto run() -> void
+	{
+		if (dirty_.empty()) return;
+
+		std::vector<recompute_node*> dirty;
+
+		dirty.swap(dirty_);
+
+		std::unordered_map<const recompute_node*, std::size_t> levels;
+		std::vector<std::pair<std::size_t, std::size_t>> order;
+
+		for (const auto node : dirty) order.emplace_back(level(node, levels), position(node));
+
+		std::sort(order.begin(), order.end());
+
+		std::vector<recompute_node*> batch;
+
+		for (std::size_t i = 0; i < order.size();)
+		{
+			batch.clear();
+
+			for (const auto current { order[i].first }; i < order.size() && order[i].first == current; i++)
+			{
+				batch.push_back(nodes_[order[i].second]);
+			}
+
+			recompute_node::connect_queue queue;
+
+			pool_->run_all(batch.size(), [&batch, &queue](std::size_t index)
+			{
+				auto& deferred { recompute_node::deferred_connects() };
+				const auto outer { std::exchange(deferred, &queue) };
+
+				batch[index]->refresh();
+				deferred = outer;
+			});
+
+			queue.connect();
+		}
+
+		for (auto& entry : order) std::swap(entry.first, entry.second);
+
+		std::sort(order.begin(), order.end());
+
+		for (const auto& entry : order)
+		{
+			const auto node { nodes_[entry.first] };
+
+			node->queued_ = false;
+			node->notify();
+		}
+	}
+
+private:
+
+	friend class recompute_node;
+
+	auto enqueue(recompute_node* node) -> void
+	{
+		if (node->queued_) return;
+
+		node->queued_ = true;
+		dirty_.push_back(node);
+	}
+
+	auto remove(recompute_node* node) -> void
+	{
+		nodes_.erase(std::find(nodes_.begin(), nodes_.end(), node));
+		dirty_.erase(std::remove(dirty_.begin(), dirty_.end(), node), dirty_.end());
+		index_.clear();
+
+		for (std::size_t i = 0; i < nodes_.size(); i++) index_[nodes_[i]->key_] = i;
+	}
+
+	auto position(const recompute_node* node) const -> std::size_t
+	{
+		return index_.at(node->key_);
+	}
+
+	// One more than the deepest getter in this scheduler which node reads.
+	auto level(const recompute_node* node, std::unordered_map<const recompute_node*, std::size_t>& levels) const -> std::size_t
+	{
+		const auto [pos, inserted] { levels.try_emplace(node, 0) };
+
+		if (!inserted) return pos->second;
+
+		std::size_t result { 0 };
+
+		node->for_each_dependency([&](const void* source)
+		{
+			const auto dependency { index_.find(source) };
+
+			if (dependency != index_.end()) result = std::max(result, level(nodes_[dependency->second], levels) + 1);
+		});
+
+		return levels[node] = result;
+	}
+
+	thread_pool* pool_;
+	std::vector<recompute_node*> nodes_;
+	std::unordered_map<const void*, std::size_t> index_;
+	std::vector<recompute_node*> dirty_;
+};
+
+inline recompute_node::~recompute_node()
+{
+	if (scheduler_) scheduler_->remove(this);
+}
+
+inline auto recompute_node::defer_notify() -> bool
+{
+	if (!scheduler_) return false;
+
+	scheduler_->enqueue(this);
+
+	return true;
+}
+
+// Single writer, single reader. The writer fills the back buffer and
+// publishes it with one atomic exchange; the reader swaps in the most
+// recently published buffer, so get() never blocks and never copies. The
+// reference returned by get() stays valid until the reader's next get().
+// Publishing never notifies, so nothing runs on the writer thread. The
+// reader calls update() at its own rate, which notifies observers on the
+// reader thread if a buffer was published since the last update().
+template <class T, class SignalType>
+class triple_buffer_property_base
+{
+public:
+
+	triple_buffer_property_base() = default;
+	triple_buffer_property_base(const T& value) : buffers_ { value, value, value } {}
+
+	auto notify() -> void
+	{
+		signal_();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	// Writer thread only
+	auto back() -> T& { return buffers_[back_]; }
+
+	auto publish() -> void
+	{
+		back_ = middle_.exchange(back_ | DIRTY, std::memory_order_acq_rel) & INDEX;
+	}
+
+	template <class U>
+	auto set(U && value) -> void
+	{
+		back() = std::forward<U>(value);
+		publish();
+	}
+
+	// Reader thread only
+	auto update(bool notify = true) -> bool
+	{
+		const auto fresh { swap() | std::exchange(unannounced_, false) };
+
+		if (fresh && notify) this->notify();
+
+		return fresh;
+	}
+
+	auto& get() const { if (swap()) unannounced_ = true; return buffers_[front_]; }
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &get(); }
+
+private:
+
+	static constexpr std::uint8_t INDEX { 0b011 };
+	static constexpr std::uint8_t DIRTY { 0b100 };
+
+	auto swap() const -> bool
+	{
+		if (!(middle_.load(std::memory_order_relaxed) & DIRTY)) return false;
+
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+
+		return true;
+	}
+
+	std::array<T, 3> buffers_ {};
+	mutable std::uint8_t front_ { 0 };
+	mutable bool unannounced_ { false };
+	alignas(64) mutable std::atomic<std::uint8_t> middle_ { 1 };
+	alignas(64) std::uint8_t back_ { 2 };
+	SignalType signal_;
+};
+
+template <class T>
+struct meter_values
+{
+	T peak {};
+	T rms {};
+	T min {};
+	T max {};
+	std::size_t count {};
+};
+
+// Any number of producers push samples into lock-free accumulators. The
+// consumer calls flush() at its own rate, which folds everything pushed
+// since the previous flush into one meter_values and notifies once. There
+// are two accumulator sets and producers write to whichever one the epoch
+// selects; flush() flips the epoch and waits for producers already inside
+// the old set to leave before reading it, so a push is never split across
+// two flushes.
+template <class T, class SignalType>
+class meter_property_base
+{
+public:
+
+	auto push(T sample) -> void
+	{
+		push(&sample, 1);
+	}
+
+	auto push(const T* samples, std::size_t count) -> void
+	{
+		if (count == 0) return;
+
+		auto min { samples[0] };
+		auto max { samples[0] };
+		auto sum_sq { 0.0 };
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			min = std::min(min, samples[i]);
+			max = std::max(max, samples[i]);
+			sum_sq += double(samples[i]) * double(samples[i]);
+		}
+
+		auto& acc { enter() };
+
+		fetch_min(acc.min, min);
+		fetch_max(acc.max, max);
+		fetch_add(acc.sum_sq, sum_sq);
+		acc.count.fetch_add(count, std::memory_order_relaxed);
+		acc.writers.fetch_sub(1, std::memory_order_release);
+	}
+
+	// Consumer thread only
+	auto flush(bool notify = true) -> bool
+	{
+		auto& acc { accumulators_[epoch_.fetch_xor(1, std::memory_order_seq_cst)] };
+
+		while (acc.writers.load(std::memory_order_seq_cst) > 0) cpu_relax();
+
+		const auto count { acc.count.exchange(0, std::memory_order_relaxed) };
+
+		if (count == 0) return false;
+
+		const auto min { acc.min.exchange(std::numeric_limits<T>::max(), std::memory_order_relaxed) };
+		const auto max { acc.max.exchange(std::numeric_limits<T>::lowest(), std::memory_order_relaxed) };
+		const auto sum_sq { acc.sum_sq.exchange(0.0, std::memory_order_relaxed) };
+
+		value_.min = min;
+		value_.max = max;
+		value_.peak = std::max(magnitude(min), magnitude(max));
+		value_.rms = T(std::sqrt(sum_sq / double(count)));
+		value_.count = count;
+
+		if (notify) this->notify();
+
+		return true;
+	}
+
+	auto notify() -> void
+	{
+		signal_();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	auto& get() const { return value_; }
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &value_; }
+
+private:
+
+	struct alignas(64) accumulator
+	{
+		std::atomic<T> min { std::numeric_limits<T>::max() };
+		std::atomic<T> max { std::numeric_limits<T>::lowest() };
+		std::atomic<double> sum_sq { 0.0 };
+		std::atomic<std::size_t> count { 0 };
+		std::atomic<std::uint32_t> writers { 0 };
+	};
+
+	// Registers the caller as a writer in the current epoch's set. If a
+	// flush flipped the epoch in the meantime the caller backs out and tries
+	// the other set, so it never writes to a set that is being read.
+	auto enter() -> accumulator&
+	{
+		for (;;)
+		{
+			const auto epoch { epoch_.load(std::memory_order_seq_cst) };
+			auto& acc { accumulators_[epoch] };
+
+			acc.writers.fetch_add(1, std::memory_order_seq_cst);
+
+			if (epoch_.load(std::memory_order_seq_cst) == epoch) return acc;
+
+			acc.writers.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	// Saturates instead of overflowing on the most negative integer.
+	static auto magnitude(T value) -> T
+	{
+		if constexpr (std::is_floating_point_v<T>) return std::abs(value);
+		else if constexpr (std::is_unsigned_v<T>) return value;
+		else return value >= 0 ? value : value == std::numeric_limits<T>::lowest() ? std::numeric_limits<T>::max() : T(-value);
+	}
+
+	template <class U>
+	static auto fetch_min(std::atomic<U>& target, U value) -> void
+	{
+		auto current { target.load(std::memory_order_relaxed) };
+
+		while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+	}
+
+	template <class U>
+	static auto fetch_max(std::atomic<U>& target, U value) -> void
+	{
+		auto current { target.load(std::memory_order_relaxed) };
+
+		while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+	}
+
+	template <class U>
+	static auto fetch_add(std::atomic<U>& target, U value) -> void
+	{
+		auto current { target.load(std::memory_order_relaxed) };
+
+		while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {}
+	}
+
+	std::array<accumulator, 2> accumulators_;
+	std::atomic<std::uint32_t> epoch_ { 0 };
+	meter_values<T> value_;
+	SignalType signal_;
+};
+
+// N values stored contiguously. Bulk writes compare against the current
+// values a block at a time in a loop the compiler can vectorise, and only
+// the indices that actually changed are notified.
+template <class T, std::size_t N, class SignalType>
+class property_array_base
+{
+public:
+
+	property_array_base() { changed_.reserve(N); dispatching_.reserve(N); }
+	property_array_base(const T& value) { values_.fill(value); changed_.reserve(N); dispatching_.reserve(N); }
+
+	// A slot which sets the array refills changed_, so the loop walks a
+	// copy. The outermost notification copies into a buffer reserved up
+	// front; only notifications from inside a slot need a buffer of their
+	// own.
+	auto notify() -> void
+	{
+		struct scope
+		{
+			scope(int& depth) : depth { depth } { depth++; }
+			~scope() { depth--; }
+
+			int& depth;
+		};
+
+		if (depth_ > 0)
+		{
+			const auto changed { changed_ };
+
+			scope scope { depth_ };
+
+			notify(changed);
+			return;
+		}
+
+		scope scope { depth_ };
+
+		dispatching_.assign(changed_.begin(), changed_.end());
+		notify(dispatching_);
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto observe(std::size_t index, Slot && slot)
+	{
+		assert(index < N);
+
+		auto& signal { index_signals_[index] };
+
+		if (!signal) signal = std::make_unique<SignalType>();
+
+		return signal->connect(std::forward<Slot>(slot));
+	}
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	template <class Range>
+	auto set_range(const Range& values, std::size_t offset = 0, bool notify = true, bool force = false) -> void
+	{
+		const auto data { std::data(values) };
+		const auto size { offset < N ? std::min(std::size_t(std::size(values)), N - offset) : std::size_t(0) };
+
+		changed_.clear();
+
+		for (std::size_t block = 0; block < size; block += BLOCK_SIZE)
+		{
+			const auto block_size { std::min(BLOCK_SIZE, size - block) };
+			const auto a { data + block };
+			const auto b { values_.data() + offset + block };
+
+			unsigned any { force };
+
+			for (std::size_t i = 0; i < block_size; i++) any |= unsigned(!(a[i] == b[i]));
+
+			if (!any) continue;
+
+			for (std::size_t i = 0; i < block_size; i++)
+			{
+				if (force || !(a[i] == b[i])) changed_.push_back(offset + block + i);
+			}
+
+			std::copy(a, a + block_size, b);
+		}
+
+		if (notify && !changed_.empty()) this->notify();
+	}
+
+	template <class U>
+	auto set(std::size_t index, U && value, bool notify = true, bool force = false) -> void
+	{
+		if (value == values_[index] && !force) return;
+
+		values_[index] = std::forward<U>(value);
+
+		changed_.clear();
+		changed_.push_back(index);
+
+		if (notify) this->notify();
+	}
+
+	auto changed() const -> const std::vector<std::size_t>& { return changed_; }
+	auto& get() const { return values_; }
+	auto& get(std::size_t index) const { return values_[index]; }
+	auto& operator[](std::size_t index) const { return values_[index]; }
+	auto data() const { return values_.data(); }
+	static constexpr auto size() { return N; }
+
+private:
+
+	static constexpr std::size_t BLOCK_SIZE { 64 };
+
+	auto notify(const std::vector<std::size_t>& changed) -> void
+	{
+		for (const auto index : changed)
+		{
+			if (index_signals_[index]) (*index_signals_[index])();
+		}
+
+		signal_();
+	}
+
+	std::array<T, N> values_ {};
+	std::vector<std::size_t> changed_;
+	std::vector<std::size_t> dispatching_;
+	int depth_ { 0 };
+	std::array<std::unique_ptr<SignalType>, N> index_signals_;
+	SignalType signal_;
+};
+
+// Holds its value as an immutable, reference counted snapshot, so that
+// handing the value out with snapshot() and putting an old one back with
+// set() are pointer copies. Setting a snapshot that is already current is
+// a no-op without comparing values. modify() edits the value in place if
+// the property allocated the current snapshot itself and nobody else
+// holds it, otherwise it edits a copy. Snapshots passed to set() may point
+// at const objects, so they are never edited in place.
+template <class T, class SignalType>
+class cow_property_base
+{
+public:
+
+	using snapshot_type = std::shared_ptr<const T>;
+
+	cow_property_base() { own(std::make_shared<T>()); }
+	cow_property_base(T value) { own(std::make_shared<T>(std::move(value))); }
+
+	auto notify() -> void
+	{
+		signal_();
+	}
+
+	auto flush() -> void
+	{
+		signal_.flush();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	auto set(snapshot_type value, bool notify = true, bool force = false) -> void
+	{
+		if (value == value_ && !force) return;
+
+		value_ = std::move(value);
+		owned_ = nullptr;
+
+		if (notify) this->notify();
+	}
+
+	template <class U, class = std::enable_if_t<std::is_convertible_v<U, T>>>
+	auto set(U && value, bool notify = true, bool force = false) -> void
+	{
+		if (*value_ == value && !force) return;
+
+		own(std::make_shared<T>(std::forward<U>(value)));
+
+		if (notify) this->notify();
+	}
+
+	template <class Fn>
+	auto modify(Fn && fn, bool notify = true) -> void
+	{
+		if (!owned_ || value_.use_count() > 1) own(std::make_shared<T>(*value_));
+
+		fn(*owned_);
+
+		if (notify) this->notify();
+	}
+
+	auto snapshot() const -> snapshot_type { return value_; }
+	auto& get() const { return std::as_const(*value_); }
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &get(); }
+
+private:
+
+	auto own(std::shared_ptr<T> value) -> void
+	{
+		owned_ = value.get();
+		value_ = std::move(value);
+	}
+
+	// owned_ points at the current value if this property allocated it.
+	snapshot_type value_;
+	T* owned_ {};
+	SignalType signal_;
+};
+
+enum class change_kind { insert, erase, move, update };
+
+// One contiguous edit. For move, the count elements which started at
+// index now start at to. The edits in a change set apply in order.
+struct range_change
+{
+	change_kind kind;
+	std::size_t index;
+	std::size_t count;
+	std::size_t to {};
+};
+
+using change_set = std::vector<range_change>;
+
+// Vector which reports what changed rather than just that something did.
+// Each edit notifies observers with the ranges it touched. Edits made
+// while a batch() guard is alive are collected, with adjacent edits of the
+// same kind merged, and observers see them as one change set when the
+// outermost guard is destroyed.
+template <class T, class SignalType>
+class observable_vector_base
+{
+public:
+
+	class [[nodiscard]] batch_guard
+	{
+	public:
+
+		batch_guard(observable_vector_base* vector) : vector_ { vector } { vector_->depth_++; }
+		batch_guard(const batch_guard& rhs) = delete;
+		batch_guard& operator=(const batch_guard& rhs) = delete;
+		~batch_guard() { if (--vector_->depth_ == 0) vector_->publish(); }
+
+	private:
+
+		observable_vector_base* vector_;
+	};
+
+	observable_vector_base() = default;
+	observable_vector_base(std::vector<T> values) : values_ { std::move(values) } {}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <auto Fn, typename Object>
+	auto observe(Object* object) { return signal_.template connect<Fn>(object); }
+
+	template <typename Object, typename Fn>
+	auto observe(Object* object, Fn fn) { return signal_.connect(object, fn); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	auto batch() { return batch_guard { this }; }
+
+	template <class U>
+	auto insert(std::size_t index, U && value) -> void
+	{
+		values_.insert(values_.begin() + index, std::forward<U>(value));
+		record({ change_kind::insert, index, 1 });
+	}
+
+	template <class Iterator>
+	auto insert(std::size_t index, Iterator first, Iterator last) -> void
+	{
+		const auto size { values_.size() };
+
+		values_.insert(values_.begin() + index, first, last);
+
+		if (values_.size() > size) record({ change_kind::insert, index, values_.size() - size });
+	}
+
+	template <class U>
+	auto push_back(U && value) -> void
+	{
+		insert(values_.size(), std::forward<U>(value));
+	}
+
+	auto erase(std::size_t index, std::size_t count = 1) -> void
+	{
+		if (count == 0) return;
+
+		values_.erase(values_.begin() + index, values_.begin() + index + count);
+		record({ change_kind::erase, index, count });
+	}
+
+	auto clear() -> void
+	{
+		erase(0, values_.size());
+	}
+
+	auto move(std::size_t from, std::size_t to, std::size_t count = 1) -> void
+	{
+		if (count == 0 || from == to) return;
+
+		const auto first { values_.begin() + from };
+
+		if (to < from) std::rotate(values_.begin() + to, first, first + count);
+		else std::rotate(first, first + count, values_.begin() + to + count);
+
+		record({ change_kind::move, from, count, to });
+	}
+
+	template <class U>
+	auto update(std::size_t index, U && value, bool force = false) -> void
+	{
+		if (values_[index] == value && !force) return;
+
+		values_[index] = std::forward<U>(value);
+		record({ change_kind::update, index, 1 });
+	}
+
+	auto& get() const { return values_; }
+	auto& operator[](std::size_t index) const { return values_[index]; }
+	auto begin() const { return values_.begin(); }
+	auto end() const { return values_.end(); }
+	auto size() const { return values_.size(); }
+	auto empty() const { return values_.empty(); }
+
+private:
+
+	auto record(range_change change) -> void
+	{
+		if (!merge(change)) pending_.push_back(change);
+		if (depth_ == 0) publish();
+	}
+
+	auto merge(const range_change& change) -> bool
+	{
+		if (pending_.empty()) return false;
+
+		auto& last { pending_.back() };
+
+		if (last.kind != change.kind) return false;
+
+		switch (change.kind)
+		{
+			case change_kind::insert:
+			case change_kind::update:
+			{
+				if (change.index != last.index + last.count) return false;
+
+				last.count += change.count;
+				return true;
+			}
+			case change_kind::erase:
+			{
+				if (change.index == last.index) { last.count += change.count; return true; }
+				if (change.index + change.count == last.index) { last.index = change.index; last.count += change.count; return true; }
+
+				return false;
+			}
+			default: return false;
+		}
+	}
+
+	auto publish() -> void
+	{
+		if (pending_.empty()) return;
+
+		change_set changes;
+
+		changes.swap(pending_);
+		signal_(std::as_const(changes));
+		changes.clear();
+
+		if (pending_.empty()) pending_.swap(changes);
+	}
+
+	std::vector<T> values_;
+	change_set pending_;
+	int depth_ { 0 };
+	SignalType signal_;
+};
+
+// Hash map which notifies per key. observe(slot) sees every insert, update
+// and erase along with the key; observe(key, slot) only sees the ones for
+// that key, and can be made before the key exists. A change only reaches
+// the observers of its own key plus the map-wide ones. A key's signal is
+// dropped once it has no slots left and the key is erased, or when the
+// signals are swept as their number grows.
+template <class K, class V, class MapSignalType, class KeySignalType>
+class observable_map_base
+{
+public:
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto observe(const K& key, Slot && slot) { return key_signal(key).connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	template <class U>
+	auto set(const K& key, U && value, bool notify = true, bool force = false) -> void
+	{
+		const auto [pos, inserted] { values_.try_emplace(key, std::forward<U>(value)) };
+
+		if (!inserted)
+		{
+			if (pos->second == value && !force) return;
+
+			pos->second = std::forward<U>(value);
+		}
+
+		if (notify) this->notify(key, inserted ? change_kind::insert : change_kind::update);
+	}
+
+	auto erase(const K& key, bool notify = true) -> bool
+	{
+		if (values_.erase(key) == 0) return false;
+
+		if (notify) this->notify(key, change_kind::erase);
+
+		if (depth_ == 0)
+		{
+			const auto pos { key_signals_.find(key) };
+
+			if (pos != key_signals_.end() && pos->second->empty()) key_signals_.erase(pos);
+		}
+
+		return true;
+	}
+
+	auto notify(const K& key, change_kind kind) -> void
+	{
+		struct scope
+		{
+			scope(int& depth) : depth { depth } { depth++; }
+			~scope() { depth--; }
+
+			int& depth;
+		};
+
+		scope scope { depth_ };
+
+		const auto pos { key_signals_.find(key) };
+
+		if (pos != key_signals_.end()) (*pos->second)(kind);
+
+		signal_(key, kind);
+	}
+
+	auto find(const K& key) const -> const V*
+	{
+		const auto pos { values_.find(key) };
+
+		return pos == values_.end() ? nullptr : &pos->second;
+	}
+
+	auto contains(const K& key) const { return values_.find(key) != values_.end(); }
+	auto& get() const { return values_; }
+	auto begin() const { return values_.begin(); }
+	auto end() const { return values_.end(); }
+	auto size() const { return values_.size(); }
+	auto empty() const { return values_.empty(); }
+
+private:
+
+	static constexpr std::size_t MIN_SWEEP { 16 };
+
+	auto key_signal(const K& key) -> KeySignalType&
+	{
+		if (key_signals_.size() >= sweep_at_) sweep();
+
+		auto& signal { key_signals_[key] };
+
+		if (!signal) signal = std::make_unique<KeySignalType>();
+
+		return *signal;
+	}
+
+	// Drops the signals nobody observes any more. Each sweep waits for the
+	// number of signals to double, so sweeping is amortized into observe().
+	// Signals can't be dropped while one of them may be running.
+	auto sweep() -> void
+	{
+		if (depth_ > 0) return;
+
+		for (auto pos { key_signals_.begin() }; pos != key_signals_.end();)
+		{
+			if (pos->second->empty()) pos = key_signals_.erase(pos);
+			else ++pos;
+		}
+
+		sweep_at_ = std::max(MIN_SWEEP, key_signals_.size() * 2);
+	}
+
+	std::unordered_map<K, V> values_;
+	std::unordered_map<K, std::unique_ptr<KeySignalType>> key_signals_;
+	std::size_t sweep_at_ { MIN_SWEEP };
+	int depth_ { 0 };
+	MapSignalType signal_;
+};
+
+template <auto A, auto B>
+constexpr auto same_member() -> bool
+{
+	if constexpr (std::is_same_v<decltype(A), decltype(B)>) return A == B;
+	else return false;
+}
+
+template <auto Member, auto... Members>
+constexpr auto field_index() -> std::size_t
+{
+	static_assert((same_member<Members, Member>() || ...), "not one of the listed fields");
+
+	std::size_t index { 0 };
+	std::size_t result { 0 };
+
+	((same_member<Members, Member>() ? result = index++ : index++), ...);
+
+	return result;
+}
+
+// Property for a struct whose fields are listed as member pointers. set()
+// works out which listed fields changed and passes that bitmask to the
+// slots. A slot observed with a mask is only run if one of its fields
+// changed; slots which share a mask share a signal, so a notification
+// costs one mask test per distinct mask rather than one per slot. Fields
+// which aren't listed are still stored but never count as a change.
+template <class T, class Fields, class SignalType>
+class aggregate_property_base;
+
+template <class T, auto... Members, class SignalType>
+class aggregate_property_base<T, fields<Members...>, SignalType>
+{
+public:
+
+	static_assert(sizeof...(Members) > 0 && sizeof...(Members) <= 64);
 
-		return *this;
+	template <auto... Ms>
+	static constexpr field_mask mask { ((field_mask(1) << field_index<Ms, Members...>()) | ...) };
+
+	static constexpr field_mask all { sizeof...(Members) == 64 ? ~field_mask(0) : (field_mask(1) << sizeof...(Members)) - 1 };
+
+	aggregate_property_base() : value_ {} {}
+	aggregate_property_base(T value) : value_ { std::move(value) } {}
+
+	// A slot observing a new mask adds a group and can move the others, so
+	// the loop goes by index. Groups added while it runs wait for the next
+	// notification.
+	auto notify(field_mask changed = all) -> void
+	{
+		const auto count { groups_.size() };
+
+		for (std::size_t index { 0 }; index < count; index++)
+		{
+			if (groups_[index].first & changed) (*groups_[index].second)(changed);
+		}
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return observe(all, std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto observe(field_mask mask, Slot && slot) { return group(mask).connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	auto set(const T& value, bool notify = true, bool force = false) -> void
+	{
+		const auto changed { force ? all : diff(value, std::index_sequence_for<decltype(Members)...> {}) };
+
+		value_ = value;
+
+		if (changed && notify) this->notify(changed);
+	}
+
+	template <auto Member, class U>
+	auto set(U && value, bool notify = true, bool force = false) -> void
+	{
+		if (value_.*Member == value && !force) return;
+
+		value_.*Member = std::forward<U>(value);
+
+		if (notify) this->notify(mask<Member>);
+	}
+
+	auto& get() const { return value_; }
+	auto& operator*() const { return get(); }
+	auto operator->() const { return &value_; }
+
+private:
+
+	template <std::size_t... I>
+	auto diff(const T& value, std::index_sequence<I...>) const -> field_mask
+	{
+		return ((field_mask(!(value.*Members == value_.*Members)) << I) | ...);
+	}
+
+	auto group(field_mask mask) -> SignalType&
+	{
+		for (const auto& [group_mask, signal] : groups_)
+		{
+			if (group_mask == mask) return *signal;
+		}
+
+		groups_.emplace_back(mask, std::make_unique<SignalType>());
+
+		return *groups_.back().second;
+	}
+
+	T value_;
+	std::vector<std::pair<field_mask, std::unique_ptr<SignalType>>> groups_;
+};
+
+#if V_SHARED_MEMORY
+
+enum class shm_mode { create, open };
+
+// Property whose value lives in a named POSIX shared memory object so that
+// other processes can read it without copying it through a socket. One
+// process creates the object and is the only writer; any number of
+// processes open it and read. Reads are guarded by a seqlock. Readers find
+// out about changes by calling update(), which notifies local observers if
+// the version moved, or by blocking in wait_for_change(), which sleeps on a
+// futex in the shared block. The writer only makes the wake syscall while
+// somebody is sleeping. The object is unlinked when the creator goes away.
+// The creator marks the block ready once it is initialised; opening one
+// that isn't ready yet throws std::system_error with EAGAIN.
+template <class T, class SignalType>
+class shared_property_base
+{
+public:
+
+	static_assert(std::is_trivially_copyable_v<T>);
+	static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+	shared_property_base(const char* name, shm_mode mode, const T& value = {})
+		: mode_ { mode }
+		, name_ { name }
+	{
+		const auto flags { mode == shm_mode::create ? O_CREAT | O_RDWR : O_RDWR };
+		const auto fd { ::shm_open(name, flags, 0600) };
+
+		if (fd < 0) throw std::system_error { errno, std::generic_category(), "shm_open" };
+
+		if (mode == shm_mode::create && ::ftruncate(fd, sizeof(block)) < 0)
+		{
+			const auto error { errno };
+			::close(fd);
+			::shm_unlink(name);
+			throw std::system_error { error, std::generic_category(), "ftruncate" };
+		}
+
+		if (mode == shm_mode::open)
+		{
+			// Mapping the object before the creator has sized it would fault
+			// on the first access.
+			struct stat st;
+
+			if (::fstat(fd, &st) < 0 || std::size_t(st.st_size) < sizeof(block))
+			{
+				::close(fd);
+				throw std::system_error { EAGAIN, std::generic_category(), "shared property not ready" };
+			}
+		}
+
+		const auto memory { ::mmap(nullptr, sizeof(block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+
+		::close(fd);
+
+		if (memory == MAP_FAILED)
+		{
+			const auto error { errno };
+			if (mode == shm_mode::create) ::shm_unlink(name);
+			throw std::system_error { error, std::generic_category(), "mmap" };
+		}
+
+		if (mode == shm_mode::create)
+		{
+			block_ = new (memory) block { {}, {}, {}, {}, sizeof(T), value };
+			block_->ready.store(block::READY, std::memory_order_release);
+		}
+		else
+		{
+			block_ = static_cast<block*>(memory);
+
+			if (block_->ready.load(std::memory_order_acquire) != block::READY)
+			{
+				::munmap(memory, sizeof(block));
+				throw std::system_error { EAGAIN, std::generic_category(), "shared property not ready" };
+			}
+
+			if (block_->size != sizeof(T))
+			{
+				::munmap(memory, sizeof(block));
+				throw std::system_error { EINVAL, std::generic_category(), "shared property size mismatch" };
+			}
+
+			seen_ = block_->version.load(std::memory_order_acquire);
+		}
+	}
+
+	shared_property_base(shared_property_base && rhs) noexcept
+		: block_ { std::exchange(rhs.block_, nullptr) }
+		, mode_ { rhs.mode_ }
+		, name_ { std::move(rhs.name_) }
+		, seen_ { rhs.seen_ }
+		, signal_ { std::move(rhs.signal_) }
+	{
+	}
+
+	~shared_property_base()
+	{
+		if (!block_) return;
+
+		::munmap(block_, sizeof(block));
+
+		if (mode_ == shm_mode::create) ::shm_unlink(name_.c_str());
+	}
+
+	auto notify() -> void
+	{
+		signal_();
+	}
+
+	template <typename Slot>
+	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+
+	template <typename Slot>
+	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+
+	// Creating process only
+	auto set(const T& value, bool notify = true, bool force = false) -> void
+	{
+		if (!force && std::memcmp(&value, &block_->value, sizeof(T)) == 0) return;
+
+		const auto seq { block_->seq.load(std::memory_order_relaxed) };
+
+		block_->seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(&block_->value, &value, sizeof(T));
+		block_->seq.store(seq + 2, std::memory_order_release);
+
+		seen_ = block_->version.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+		if (block_->sleepers.load(std::memory_order_seq_cst) > 0)
+		{
+			::syscall(SYS_futex, &block_->version, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+		}
+
+		if (notify) this->notify();
+	}
+
+	auto get() const -> T
+	{
+		T value;
+
+		for (;;)
+		{
+			const auto seq { block_->seq.load(std::memory_order_acquire) };
+
+			if (seq & 1)
+			{
+				cpu_relax();
+				continue;
+			}
+
+			std::memcpy(&value, &block_->value, sizeof(T));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (block_->seq.load(std::memory_order_relaxed) == seq) return value;
+		}
+	}
+
+	auto operator*() const { return get(); }
+
+	auto version() const { return block_->version.load(std::memory_order_acquire); }
+
+	// Notifies local observers if the value changed since the last call.
+	auto update() -> bool
+	{
+		const auto version { this->version() };
+
+		if (version == seen_) return false;
+
+		seen_ = version;
+		notify();
+
+		return true;
+	}
+
+	// Blocks until the version moves past the one last seen by update().
+	// Returns false if the timeout expired first.
+	template <class Rep, class Period>
+	auto wait_for_change(std::chrono::duration<Rep, Period> timeout) const -> bool
+	{
+		return wait(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+	}
+
+	auto wait_for_change() const -> void
+	{
+		wait(std::nullopt);
+	}
+
+private:
+
+	struct block
+	{
+		static constexpr std::uint32_t READY { 0x76736870 };
+
+		std::atomic<std::uint32_t> ready;
+		std::atomic<std::uint32_t> seq;
+		std::atomic<std::uint32_t> version;
+		std::atomic<std::uint32_t> sleepers;
+		std::uint32_t size;
+		T value;
+	};
+
+	// Each wakeup recomputes what is left of the timeout, so spurious and
+	// stale wakeups don't extend it.
+	auto wait(std::optional<std::chrono::steady_clock::time_point> deadline) const -> bool
+	{
+		if (version() != seen_) return true;
+
+		block_->sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+		while (block_->version.load(std::memory_order_seq_cst) == seen_)
+		{
+			timespec ts {};
+
+			if (deadline)
+			{
+				const auto remaining { std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - std::chrono::steady_clock::now()).count() };
+
+				if (remaining <= 0) break;
+
+				ts = { time_t(remaining / 1'000'000'000), long(remaining % 1'000'000'000) };
+			}
+
+			::syscall(SYS_futex, &block_->version, FUTEX_WAIT, seen_, deadline ? &ts : nullptr, nullptr, 0);
+		}
+
+		block_->sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+		return version() != seen_;
+	}
+
+	block* block_;
+	shm_mode mode_;
+	std::string name_;
+	std::uint32_t seen_ { 0 };
+	SignalType signal_;
+};
+
+#endif
+
+} // detail
+
+template <typename T, typename Threading = threading::none, typename Storage = storage::heap, typename Dispatch = dispatch::sync> using basic_getter = detail::getter_base<T, detail::basic_signal_impl<void(), Threading, Storage, Dispatch>>;
+template <typename T, typename Threading = threading::none, typename Storage = storage::heap, typename Dispatch = dispatch::sync> using basic_property = detail::property_base<T, detail::basic_signal_impl<void(), Threading, Storage, Dispatch>>;
+template <typename T, typename Threading = threading::none, typename Storage = storage::heap, typename Dispatch = dispatch::sync> using basic_property_setter = detail::property_setter_base<T, detail::basic_signal_impl<void(), Threading, Storage, Dispatch>>;
+template <typename T, typename Threading = threading::none, typename Storage = storage::heap, typename Dispatch = dispatch::sync> using basic_read_only_property = detail::read_only_property_base<T, detail::basic_signal_impl<void(), Threading, Storage, Dispatch>>;
+template <typename T, typename Threading = threading::none, typename Storage = storage::heap, typename Dispatch = dispatch::sync> using basic_signal = detail::signal_base<detail::basic_signal_impl<T, Threading, Storage, Dispatch>>;
+
+template <typename T> using getter = basic_getter<T>;
+template <typename T> using property = basic_property<T>;
+template <typename T> using property_setter = basic_property_setter<T>;
+template <typename T> using read_only_property = basic_read_only_property<T>;
+template <typename T> using signal = basic_signal<T>;
+
+template <typename T, std::size_t N, overflow_policy Overflow = overflow_policy::terminate> using static_getter = basic_getter<T, threading::none, storage::inline_n<N, Overflow>>;
+template <typename T, std::size_t N, overflow_policy Overflow = overflow_policy::terminate> using static_property = basic_property<T, threading::none, storage::inline_n<N, Overflow>>;
+template <typename T, std::size_t N, overflow_policy Overflow = overflow_policy::terminate> using static_property_setter = basic_property_setter<T, threading::none, storage::inline_n<N, Overflow>>;
+template <typename T, std::size_t N, overflow_policy Overflow = overflow_policy::terminate> using static_read_only_property = basic_read_only_property<T, threading::none, storage::inline_n<N, Overflow>>;
+template <typename T, std::size_t N, overflow_policy Overflow = overflow_policy::terminate> using static_signal = basic_signal<T, threading::none, storage::inline_n<N, Overflow>>;
+template <typename T, std::size_t N> using property_array = detail::property_array_base<T, N, detail::boost_signal<void()>>;
+template <typename T> using cow_property = detail::cow_property_base<T, detail::boost_signal<void()>>;
+template <typename T> using tracking_getter = detail::tracking_getter_base<T, detail::boost_signal<void()>>;
+using detail::recompute_scheduler;
+template <typename T> using observable_vector = detail::observable_vector_base<T, detail::boost_signal<void(const detail::change_set&)>>;
+template <typename K, typename V> using observable_map = detail::observable_map_base<K, V, detail::boost_signal<void(const K&, detail::change_kind)>, detail::boost_signal<void(detail::change_kind)>>;
+template <typename T, typename Fields> using aggregate_property = detail::aggregate_property_base<T, Fields, detail::boost_signal<void(field_mask)>>;
+using detail::change_kind;
+using detail::change_set;
+using detail::range_change;
+
+#if V_SHARED_MEMORY
+using detail::shm_mode;
+template <typename T> using shared_property = detail::shared_property_base<T, detail::boost_signal<void()>>;
+#endif
+
+using detail::meter_values;
+
+namespace mt {
+
+template <typename T> using mt_getter = basic_getter<T, threading::mutex>;
+template <typename T> using mt_property = basic_property<T, threading::mutex>;
+template <typename T> using mt_property_setter = basic_property_setter<T, threading::mutex>;
+template <typename T> using mt_read_only_property = basic_read_only_property<T, threading::mutex>;
+template <typename T> using mt_signal = basic_signal<T, threading::mutex>;
+template <typename T> using mt_spin_getter = basic_getter<T, threading::spinlock>;
+template <typename T> using mt_spin_property = basic_property<T, threading::spinlock>;
+template <typename T> using mt_spin_property_setter = basic_property_setter<T, threading::spinlock>;
+template <typename T> using mt_spin_read_only_property = basic_read_only_property<T, threading::spinlock>;
+template <typename T> using mt_spin_signal = basic_signal<T, threading::spinlock>;
+template <typename T, std::size_t N> using mt_property_array = detail::property_array_base<T, N, detail::boost_mt_signal<void()>>;
+template <typename T> using mt_triple_buffer_property = detail::triple_buffer_property_base<T, detail::boost_mt_signal<void()>>;
+template <typename T = float> using mt_meter_property = detail::meter_property_base<T, detail::boost_mt_signal<void()>>;
+#if V_SHARED_MEMORY
+template <typename T> using mt_shared_property = detail::shared_property_base<T, detail::boost_mt_signal<void()>>;
+#endif
+
+} // mt
+
+#if V_EVENTFD
+
+// Hands notifications over to a poll/epoll based event loop. Slots observed
+// through it don't run when the signal fires; the call is queued and fd()
+// becomes readable. The loop thread then calls drain() to run everything
+// queued so far. Only the first notification after a drain touches the
+// eventfd.
+class fd_notifier
+{
+public:
+
+	fd_notifier()
+		: fd_ { ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) }
+	{
+		if (fd_ < 0) throw std::system_error { errno, std::generic_category(), "eventfd" };
+	}
+
+	fd_notifier(const fd_notifier& rhs) = delete;
+	fd_notifier& operator=(const fd_notifier& rhs) = delete;
+
+	~fd_notifier()
+	{
+		::close(fd_);
+	}
+
+	auto fd() const { return fd_; }
+
+	template <class Observable, class Slot>
+	auto observe(Observable& observable, Slot slot)
+	{
+		return observable.observe([this, slot](auto&&... args)
+		{
+			post([slot, args = std::make_tuple(args...)]() { std::apply(slot, args); });
+		});
+	}
+
+	auto post(std::function<void()> fn) -> void
+	{
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+
+			queue_.push_back(std::move(fn));
+
+			if (queue_.size() > 1) return;
+		}
+
+		const std::uint64_t one { 1 };
+
+		while (::write(fd_, &one, sizeof(one)) < 0 && errno == EINTR) {}
+	}
+
+	auto drain() -> void
+	{
+		std::uint64_t count;
+
+		while (::read(fd_, &count, sizeof(count)) < 0 && errno == EINTR) {}
+
+		std::vector<std::function<void()>> queue;
+
+		{
+			std::lock_guard<std::mutex> lock { mutex_ };
+
+			queue.swap(queue_);
+		}
+
+		for (const auto& fn : queue) fn();
+	}
+
+private:
+
+	int fd_;
+	std::mutex mutex_;
+	std::vector<std::function<void()>> queue_;
+};
+
+#endif
+
+#if V_SHARED_MEMORY
+
+namespace detail {
+
+struct feed_header
+{
+	static constexpr std::uint32_t MAGIC { 0x76666432 };
+
+	std::uint32_t magic;
+	std::uint32_t header_size;
+	std::uint64_t capacity;
+	alignas(64) std::atomic<std::uint64_t> head;
+	std::atomic<std::uint64_t> dropped;
+	alignas(64) std::atomic<std::uint64_t> tail;
+};
+
+struct feed_record_header
+{
+	static constexpr std::uint32_t PADDING { 0xFFFFFFFF };
+
+	std::uint32_t size;
+	std::uint32_t id;
+	std::uint64_t version;
+	std::int64_t timestamp;
+	std::uint32_t length;
+};
+
+class feed_mapping
+{
+public:
+
+	feed_mapping(const char* path, int flags, std::size_t capacity)
+	{
+		const auto fd { ::open(path, flags | O_CLOEXEC, 0644) };
+
+		if (fd < 0) throw std::system_error { errno, std::generic_category(), "open" };
+
+		auto size { sizeof(feed_header) + capacity };
+
+		if (capacity > 0 && ::ftruncate(fd, off_t(size)) < 0)
+		{
+			const auto error { errno };
+			::close(fd);
+			throw std::system_error { error, std::generic_category(), "ftruncate" };
+		}
+
+		if (capacity == 0)
+		{
+			struct stat st;
+
+			if (::fstat(fd, &st) < 0 || std::size_t(st.st_size) < sizeof(feed_header))
+			{
+				::close(fd);
+				throw std::system_error { EINVAL, std::generic_category(), "not a change feed" };
+			}
+
+			size = std::size_t(st.st_size);
+		}
+
+		memory_ = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		size_ = size;
+
+		::close(fd);
+
+		if (memory_ == MAP_FAILED) throw std::system_error { errno, std::generic_category(), "mmap" };
+	}
+
+	feed_mapping(const feed_mapping& rhs) = delete;
+	feed_mapping& operator=(const feed_mapping& rhs) = delete;
+
+	~feed_mapping()
+	{
+		::munmap(memory_, size_);
+	}
+
+	auto header() const { return static_cast<feed_header*>(memory_); }
+	auto data() const { return static_cast<std::byte*>(memory_) + sizeof(feed_header); }
+	auto size() const { return size_; }
+
+private:
+
+	void* memory_;
+	std::size_t size_;
+};
+
+} // detail
+
+struct feed_record
+{
+	std::uint32_t id;
+	std::uint64_t version;
+	std::int64_t timestamp;
+	const void* data;
+	std::size_t size;
+};
+
+// Streams property changes into a memory mapped file laid out as a single
+// producer, single consumer ring of binary records, for another process to
+// tail with change_feed_reader. Writing a record only touches the mapping:
+// no locks and no syscalls. If the reader falls behind, new records are
+// dropped and counted rather than blocking the producer. All registered
+// properties must be set from the same thread.
+class change_feed
+{
+public:
+
+	// capacity is rounded up to a power of two.
+	change_feed(const char* path, std::size_t capacity)
+		: map_ { path, O_CREAT | O_RDWR | O_TRUNC, round_up(capacity) }
+	{
+		const auto header { map_.header() };
+
+		header->magic = detail::feed_header::MAGIC;
+		header->header_size = sizeof(detail::feed_header);
+		header->capacity = map_.size() - sizeof(detail::feed_header);
+		header->head.store(0, std::memory_order_relaxed);
+		header->dropped.store(0, std::memory_order_relaxed);
+		header->tail.store(0, std::memory_order_release);
+	}
+
+	// Writes a record with the property's value every time it changes.
+	template <class Property>
+	auto add(Property& property, std::uint32_t id)
+	{
+		using value_t = std::decay_t<decltype(property.get())>;
+
+		static_assert(std::is_trivially_copyable_v<value_t>);
+
+		return property.observe([this, &property, id, version = std::uint64_t { 0 }]() mutable
+		{
+			const value_t value { property.get() };
+
+			write(id, ++version, &value, sizeof(value));
+		});
 	}
 
-	auto set(const T& value, bool notify = true, bool force = false) -> void
+	auto write(std::uint32_t id, std::uint64_t version, const void* data, std::size_t size) -> bool
+	{
+		const auto header { map_.header() };
+		const auto capacity { header->capacity };
+		const auto total { align(sizeof(detail::feed_record_header) + size) };
+		auto head { header->head.load(std::memory_order_relaxed) };
+		const auto tail { header->tail.load(std::memory_order_acquire) };
+		const auto offset { head & (capacity - 1) };
+		const auto to_end { capacity - offset };
+		const auto wrap { total > to_end };
+
+		if (head + total + (wrap ? to_end : 0) - tail > capacity)
+		{
+			header->dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (wrap)
+		{
+			const auto padding { reinterpret_cast<detail::feed_record_header*>(map_.data() + offset) };
+
+			padding->size = std::uint32_t(to_end);
+			padding->id = detail::feed_record_header::PADDING;
+			head += to_end;
+		}
+
+		const auto record { reinterpret_cast<detail::feed_record_header*>(map_.data() + (head & (capacity - 1))) };
+
+		record->size = std::uint32_t(total);
+		record->id = id;
+		record->length = std::uint32_t(size);
+		record->version = version;
+		record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		std::memcpy(record + 1, data, size);
+
+		header->head.store(head + total, std::memory_order_release);
+
+		return true;
+	}
+
+	auto dropped() const { return map_.header()->dropped.load(std::memory_order_relaxed); }
+
+private:
+
+	static auto align(std::size_t size) -> std::size_t { return (size + 7) & ~std::size_t(7); }
+
+	static auto round_up(std::size_t capacity) -> std::size_t
 	{
-		if (flag_) return;
+		std::size_t size { 64 };
 
-		property_base<T, SignalType>::set(value, notify, force);
+		while (size < capacity) size <<= 1;
 
-		flag_ = true;
+		return size;
 	}
 
-private:
-
-	bool flag_{ false };
+	detail::feed_mapping map_;
 };
 
-template <class T, class SignalType>
-class getter_base
+class change_feed_reader
 {
 public:
 
-	using getter_fn = std::function<T()>;
+	change_feed_reader(const char* path)
+		: map_ { path, O_RDWR, 0 }
+	{
+		const auto header { map_.header() };
 
-	getter_base() = default;
-	getter_base(getter_fn getter) : getter_ { getter } {}
+		if (header->magic != detail::feed_header::MAGIC || header->header_size != sizeof(detail::feed_header) || header->capacity + sizeof(detail::feed_header) > map_.size())
+		{
+			throw std::system_error { EINVAL, std::generic_category(), "not a change feed" };
+		}
+	}
 
-	auto notify() -> void
+	// Calls fn(const feed_record&) for every record written since the last
+	// call and returns how many there were. The record's data pointer is
+	// only valid during the call.
+	template <class Fn>
+	auto read(Fn && fn) -> std::size_t
 	{
-		signal_();
-	}
+		const auto header { map_.header() };
+		const auto capacity { header->capacity };
+		const auto head { header->head.load(std::memory_order_acquire) };
+		auto tail { header->tail.load(std::memory_order_relaxed) };
+		std::size_t count { 0 };
 
-	template <typename Slot>
-	auto observe(Slot && slot) { return signal_.connect(std::forward<Slot>(slot)); }
+		while (tail != head)
+		{
+			const auto record { reinterpret_cast<const detail::feed_record_header*>(map_.data() + (tail & (capacity - 1))) };
 
-	template <typename Slot>
-	auto operator>>(Slot && slot) { return observe(std::forward<Slot>(slot)); }
+			if (record->id != detail::feed_record_header::PADDING)
+			{
+				fn(feed_record { record->id, record->version, record->timestamp, record + 1, record->length });
+				count++;
+			}
 
-	auto observer()
-	{
-		const auto connect { [this](v::slot<void()> slot)
-		{
-			return signal_.connect(slot);
-		}};
+			tail += record->size;
+		}
 
-		return getter_observer<T> { getter_, connect };
+		header->tail.store(tail, std::memory_order_release);
+
+		return count;
 	}
 
-	auto set(getter_fn getter) { getter_ = getter; }
-	auto get() const { return getter_(); }
-	auto operator()() const { return get(); }
-	auto operator*() const { return get(); }
+	auto dropped() const { return map_.header()->dropped.load(std::memory_order_relaxed); }
 
 private:
 
-	getter_fn getter_;
-	SignalType signal_;
+	detail::feed_mapping map_;
 };
 
-} // detail
-
-template <typename T> using getter = detail::getter_base<T, detail::boost_signal<void()>>;
-template <typename T> using property = detail::property_base<T, detail::boost_signal<void()>>;
-template <typename T> using property_setter = detail::property_setter_base<T, detail::boost_signal<void()>>;
-template <typename T> using read_only_property = detail::read_only_property_base<T, detail::boost_signal<void()>>;
-template <typename T> using signal = detail::signal_base<detail::boost_signal<T>>;
-
-namespace mt {
-
-template <typename T> using mt_getter = detail::getter_base<T, detail::boost_mt_signal<void()>>;
-template <typename T> using mt_property = detail::property_base<T, detail::boost_mt_signal<void()>>;
-template <typename T> using mt_property_setter = detail::property_setter_base<T, detail::boost_mt_signal<void()>>;
-template <typename T> using mt_read_only_property = detail::read_only_property_base<T, detail::boost_mt_signal<void()>>;
-template <typename T> using mt_signal = detail::signal_base<detail::boost_mt_signal<T>>;
-
-} // mt
+#endif
 
 class expiry_token
 {
@@ -537,4 +5027,506 @@ private:
 	std::unordered_map<size_t, v::scoped_cn> attached_objects_;
 };
 
+class timer_wheel;
+
+// Timer which lives inside whatever owns it, so scheduling allocates
+// nothing. It cancels itself when destroyed.
+class timer_node
+{
+public:
+
+	using fire_fn = void(*)(timer_node* node);
+
+	timer_node(fire_fn fire = nullptr) : fire_ { fire } {}
+	timer_node(const timer_node& rhs) = delete;
+	timer_node& operator=(const timer_node& rhs) = delete;
+	~timer_node() { cancel(); }
+
+	auto scheduled() const { return wheel_ != nullptr; }
+
+	auto cancel() -> void
+	{
+		if (!wheel_) return;
+
+		prev_->next_ = next_;
+		next_->prev_ = prev_;
+		prev_ = next_ = this;
+		wheel_ = nullptr;
+	}
+
+private:
+
+	friend class timer_wheel;
+
+	timer_node* prev_ { this };
+	timer_node* next_ { this };
+	timer_wheel* wheel_ {};
+	std::uint64_t expires_ {};
+	fire_fn fire_;
+};
+
+// Hierarchical timing wheel: four levels of 64 slots, each level's slot
+// covering one full turn of the level below. Scheduling and cancelling are
+// O(1) and a tick only touches the timers which are due, or which move
+// down a level, so the cost doesn't grow with the number of timers
+// waiting. Time only moves when the owner calls advance() or update(),
+// from an event loop or with a simulated clock in tests. Not thread safe.
+class timer_wheel
+{
+public:
+
+	timer_wheel(std::chrono::nanoseconds resolution = std::chrono::milliseconds { 1 })
+		: resolution_ { resolution }
+	{
+	}
+
+	timer_wheel(const timer_wheel& rhs) = delete;
+	timer_wheel& operator=(const timer_wheel& rhs) = delete;
+
+	~timer_wheel()
+	{
+		for (auto& level : slots_)
+		{
+			for (auto& slot : level)
+			{
+				while (slot.next_ != &slot) slot.next_->cancel();
+			}
+		}
+	}
+
+	auto schedule(timer_node* node, std::chrono::nanoseconds delay) -> void
+	{
+		node->cancel();
+		node->expires_ = now_ + std::max<std::uint64_t>(1, std::uint64_t((delay + resolution_ - std::chrono::nanoseconds { 1 }) / resolution_));
+		insert(node);
+	}
+
+	auto advance(std::chrono::nanoseconds elapsed) -> void
+	{
+		remainder_ += elapsed;
+
+		while (remainder_ >= resolution_)
+		{
+			remainder_ -= resolution_;
+			tick();
+		}
+	}
+
+	auto update(std::chrono::steady_clock::time_point now) -> void
+	{
+		if (last_update_ != std::chrono::steady_clock::time_point {}) advance(now - last_update_);
+
+		last_update_ = now;
+	}
+
+	auto now() const { return now_; }
+
+private:
+
+	static constexpr std::uint64_t BITS { 6 };
+	static constexpr std::uint64_t SLOTS { 1 << BITS };
+	static constexpr std::uint64_t MASK { SLOTS - 1 };
+	static constexpr std::size_t LEVELS { 4 };
+
+	auto insert(timer_node* node) -> void
+	{
+		const auto delta { node->expires_ - now_ };
+		std::size_t level { 0 };
+
+		while (level < LEVELS - 1 && delta >= (std::uint64_t(1) << (BITS * (level + 1)))) level++;
+
+		const auto expires { std::min(node->expires_, now_ + (std::uint64_t(1) << (BITS * LEVELS)) - 1) };
+		auto& slot { slots_[level][(expires >> (BITS * level)) & MASK] };
+
+		node->wheel_ = this;
+		node->prev_ = slot.prev_;
+		node->next_ = &slot;
+		slot.prev_->next_ = node;
+		slot.prev_ = node;
+	}
+
+	auto tick() -> void
+	{
+		now_++;
+
+		for (std::size_t level = 1; level < LEVELS; level++)
+		{
+			if (now_ & ((std::uint64_t(1) << (BITS * level)) - 1)) break;
+
+			auto& slot { slots_[level][(now_ >> (BITS * level)) & MASK] };
+
+			while (slot.next_ != &slot)
+			{
+				const auto node { slot.next_ };
+
+				node->cancel();
+				insert(node);
+			}
+		}
+
+		auto& slot { slots_[0][now_ & MASK] };
+
+		while (slot.next_ != &slot)
+		{
+			const auto node { slot.next_ };
+
+			node->cancel();
+
+			if (node->expires_ > now_) insert(node);
+			else node->fire_(node);
+		}
+	}
+
+	std::chrono::nanoseconds resolution_;
+	std::chrono::nanoseconds remainder_ {};
+	std::chrono::steady_clock::time_point last_update_ {};
+	std::uint64_t now_ { 0 };
+	std::array<std::array<timer_node, SLOTS>, LEVELS> slots_;
+};
+
+namespace detail {
+
+template <class... T> struct type_list {};
+
+inline auto add_connection(store& connections, cn && c) -> void { connections += scoped_cn { std::move(c) }; }
+inline auto add_connection(store& connections, intrusive_cn && c) -> void { connections += std::move(c); }
+
+template <class Source, class = void>
+struct pipeline_source
+{
+	using args = type_list<std::decay_t<decltype(std::declval<Source&>().get())>>;
+
+	template <class Fn>
+	static auto connect(Source& source, Fn fn) { return source.observe([&source, fn]() mutable { fn(source.get()); }); }
+};
+
+template <class Source>
+struct pipeline_source<Source, std::void_t<typename Source::signature>>
+{
+	template <class Signature> struct args_of;
+	template <class... Args> struct args_of<void(Args...)> { using type = type_list<std::decay_t<Args>...>; };
+
+	using args = typename args_of<typename Source::signature>::type;
+
+	template <class Fn>
+	static auto connect(Source& source, Fn fn) { return source.observe([fn](const auto&... args) mutable { fn(args...); }); }
+};
+
+// Each stage turns the callable for the rest of the pipeline into the
+// callable for the stage before it. output<In...> is the list of values
+// the stage passes on when it receives In...
+template <class Fn>
+struct map_stage
+{
+	template <class... In> using output = type_list<std::decay_t<std::invoke_result_t<Fn&, const In&...>>>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&) { return [fn = fn_, next](const In&... in) mutable { next(fn(in...)); }; }
+
+	Fn fn_;
+};
+
+template <class Pred>
+struct filter_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&) { return [pred = pred_, next](const In&... in) mutable { if (pred(in...)) next(in...); }; }
+
+	Pred pred_;
+};
+
+struct distinct_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&)
+	{
+		return [next, last = std::optional<std::tuple<In...>> {}](const In&... in) mutable
+		{
+			if (last && *last == std::tie(in...)) return;
+
+			last.emplace(in...);
+			next(in...);
+		};
+	}
+};
+
+template <class Acc, class Fn>
+struct scan_stage
+{
+	template <class... In> using output = type_list<Acc>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&)
+	{
+		return [acc = init_, fn = fn_, next](const In&... in) mutable
+		{
+			acc = fn(std::as_const(acc), in...);
+			next(std::as_const(acc));
+		};
+	}
+
+	Acc init_;
+	Fn fn_;
+};
+
+template <class Expirable>
+struct take_until_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store& connections)
+	{
+		const auto alive { std::make_shared<bool>(true) };
+
+		add_connection(connections, object_->observe_expiry([alive] { *alive = false; }));
+
+		return [alive, next](const In&... in) mutable { if (*alive) next(in...); };
+	}
+
+	Expirable* object_;
+};
+
+template <class Other>
+struct combine_latest_stage
+{
+	using other_t = std::decay_t<decltype(std::declval<Other&>().get())>;
+
+	template <class... In> using output = type_list<In..., other_t>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store& connections)
+	{
+		struct state { std::optional<std::tuple<In...>> last; Next next; };
+
+		const auto shared { std::make_shared<state>(state { std::nullopt, std::move(next) }) };
+		const auto other { other_ };
+
+		add_connection(connections, other->observe([shared, other]
+		{
+			if (!shared->last) return;
+
+			std::apply([&](const In&... in) { shared->next(in..., other->get()); }, *shared->last);
+		}));
+
+		return [shared, other](const In&... in)
+		{
+			shared->last.emplace(in...);
+			shared->next(in..., other->get());
+		};
+	}
+
+	Other* other_;
+};
+
+template <class Trigger>
+struct sample_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store& connections)
+	{
+		struct state { std::optional<std::tuple<In...>> last; Next next; };
+
+		const auto shared { std::make_shared<state>(state { std::nullopt, std::move(next) }) };
+
+		add_connection(connections, trigger_->observe([shared](const auto&...)
+		{
+			if (shared->last) std::apply(shared->next, *shared->last);
+		}));
+
+		return [shared](const In&... in) { shared->last.emplace(in...); };
+	}
+
+	Trigger* trigger_;
+};
+
+// Passes on the last values once the source has been quiet for delay.
+template <class Next, class... In>
+struct debounce_state : timer_node
+{
+	debounce_state(Next next) : timer_node { &fire }, next_ { std::move(next) } {}
+
+	static auto fire(timer_node* node) -> void
+	{
+		auto& state { static_cast<debounce_state&>(*node) };
+
+		std::apply(state.next_, *state.last_);
+	}
+
+	Next next_;
+	std::optional<std::tuple<In...>> last_;
+};
+
+struct debounce_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&)
+	{
+		const auto state { std::make_shared<debounce_state<Next, In...>>(std::move(next)) };
+
+		return [state, wheel = wheel_, delay = delay_](const In&... in)
+		{
+			state->last_.emplace(in...);
+			wheel->schedule(state.get(), delay);
+		};
+	}
+
+	timer_wheel* wheel_;
+	std::chrono::nanoseconds delay_;
+};
+
+// Passes the first values on straight away, then at most once per
+// interval: values arriving within the interval are held back and the
+// latest of them is passed on when it ends.
+template <class Next, class... In>
+struct throttle_state : timer_node
+{
+	throttle_state(timer_wheel* wheel, std::chrono::nanoseconds interval, Next next)
+		: timer_node { &fire }
+		, wheel_ { wheel }
+		, interval_ { interval }
+		, next_ { std::move(next) }
+	{
+	}
+
+	static auto fire(timer_node* node) -> void
+	{
+		auto& state { static_cast<throttle_state&>(*node) };
+
+		if (!state.pending_) return;
+
+		state.pending_ = false;
+		state.wheel_->schedule(node, state.interval_);
+		std::apply(state.next_, *state.last_);
+	}
+
+	auto operator()(const In&... in) -> void
+	{
+		if (scheduled())
+		{
+			last_.emplace(in...);
+			pending_ = true;
+			return;
+		}
+
+		wheel_->schedule(this, interval_);
+		next_(in...);
+	}
+
+	timer_wheel* wheel_;
+	std::chrono::nanoseconds interval_;
+	Next next_;
+	std::optional<std::tuple<In...>> last_;
+	bool pending_ { false };
+};
+
+struct throttle_stage
+{
+	template <class... In> using output = type_list<In...>;
+
+	template <class... In, class Next>
+	auto bind(Next next, store&)
+	{
+		const auto state { std::make_shared<throttle_state<Next, In...>>(wheel_, interval_, std::move(next)) };
+
+		return [state](const In&... in) { (*state)(in...); };
+	}
+
+	timer_wheel* wheel_;
+	std::chrono::nanoseconds interval_;
+};
+
+template <std::size_t I, class List>
+struct pipeline_composer;
+
+template <std::size_t I, class... In>
+struct pipeline_composer<I, type_list<In...>>
+{
+	template <class Stages, class Sink>
+	static auto bind(Stages& stages, Sink sink, store& connections)
+	{
+		if constexpr (I == std::tuple_size_v<Stages>)
+		{
+			return [sink](const In&... in) mutable { sink(in...); };
+		}
+		else
+		{
+			auto& stage { std::get<I>(stages) };
+
+			using output = typename std::decay_t<decltype(stage)>::template output<In...>;
+
+			return stage.template bind<In...>(pipeline_composer<I + 1, output>::bind(stages, std::move(sink), connections), connections);
+		}
+	}
+};
+
+// Chain of operators over a signal or property. Nothing is connected until
+// the pipeline is observed; then all the operators are fused into a single
+// slot on the source, so a notification costs one connection's dispatch
+// however many operators there are. combine_latest, sample and take_until
+// also have to listen to a second object, and make one more connection
+// each. Observing returns a store holding every connection made.
+template <class Source, class... Stages>
+class pipeline
+{
+public:
+
+	pipeline(Source& source, std::tuple<Stages...> stages)
+		: source_ { source }
+		, stages_ { std::move(stages) }
+	{
+	}
+
+	template <class Stage>
+	auto operator|(Stage stage) &&
+	{
+		return pipeline<Source, Stages..., Stage> { source_, std::tuple_cat(std::move(stages_), std::make_tuple(std::move(stage))) };
+	}
+
+	template <class Sink>
+	auto observe(Sink sink) -> store
+	{
+		store connections;
+
+		auto fn { pipeline_composer<0, typename pipeline_source<Source>::args>::bind(stages_, std::move(sink), connections) };
+
+		add_connection(connections, pipeline_source<Source>::connect(source_, std::move(fn)));
+
+		return connections;
+	}
+
+	template <class Sink>
+	auto operator>>(Sink sink) { return observe(std::move(sink)); }
+
+private:
+
+	Source& source_;
+	std::tuple<Stages...> stages_;
+};
+
+} // detail
+
+namespace rx {
+
+template <class Source> auto from(Source& source) { return detail::pipeline<Source> { source, {} }; }
+template <class Fn> auto map(Fn fn) { return detail::map_stage<Fn> { std::move(fn) }; }
+template <class Pred> auto filter(Pred pred) { return detail::filter_stage<Pred> { std::move(pred) }; }
+inline auto distinct() { return detail::distinct_stage {}; }
+template <class Acc, class Fn> auto scan(Acc init, Fn fn) { return detail::scan_stage<Acc, Fn> { std::move(init), std::move(fn) }; }
+template <class Expirable> auto take_until(Expirable* object) { return detail::take_until_stage<Expirable> { object }; }
+template <class Other> auto combine_latest(Other& other) { return detail::combine_latest_stage<Other> { &other }; }
+template <class Trigger> auto sample(Trigger& trigger) { return detail::sample_stage<Trigger> { &trigger }; }
+inline auto debounce(timer_wheel& wheel, std::chrono::nanoseconds delay) { return detail::debounce_stage { &wheel, delay }; }
+inline auto throttle(timer_wheel& wheel, std::chrono::nanoseconds interval) { return detail::throttle_stage { &wheel, interval }; }
+
+} // rx
+
 } // v
@@ -0,0 +1,63 @@
+// A slot which observes a new field mask while the property is notifying
+// adds a group, which can reallocate the group list under the loop. The
+// notification carries on safely and the new group only sees later changes.
+
+#include <v.hpp>
+#include <cstdio>
+#include <vector>
+
+#define CHECK(expr) do { if (!(expr)) { std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); return 1; } } while (false)
+
+namespace {
+
+struct point
+{
+	int x {};
+	int y {};
+	int z {};
+};
+
+using point_property = v::aggregate_property<point, v::fields<&point::x, &point::y, &point::z>>;
+
+auto observe_while_notifying() -> int
+{
+	point_property property;
+	std::vector<v::scoped_cn> connections;
+	auto x_calls { 0 };
+	auto added_calls { 0 };
+
+	connections.emplace_back(property.observe(point_property::mask<&point::x>, [&](v::field_mask)
+	{
+		x_calls++;
+
+		// Enough new masks to force the group list to grow.
+		for (v::field_mask mask { 1 }; mask < 8; mask++)
+		{
+			connections.emplace_back(property.observe(mask << 3 | mask, [&](v::field_mask) { added_calls++; }));
+		}
+	}));
+
+	connections.emplace_back(property.observe(point_property::mask<&point::y>, [&](v::field_mask) {}));
+
+	property.set<&point::x>(1);
+
+	CHECK(x_calls == 1);
+	CHECK(added_calls == 0);
+
+	// The masks 2, 3, 6 and 7 include y.
+	property.set<&point::y>(1);
+
+	CHECK(x_calls == 1);
+	CHECK(added_calls == 4);
+
+	return 0;
+}
+
+} // namespace
+
+int main()
+{
+	if (const auto result { observe_while_notifying() }) return result;
+
+	return 0;
+}
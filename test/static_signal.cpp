@@ -0,0 +1,139 @@
+// Every slot stored inline is constructed and destroyed exactly once, however
+// many times the slot list moves it around, and the connection and observer
+// types used with heap signals work with inline ones too.
+
+#include <v.hpp>
+#include <cstdio>
+#include <utility>
+
+#define CHECK(expr) do { if (!(expr)) { std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); return 1; } } while (false)
+
+namespace {
+
+int constructed { 0 };
+int destroyed { 0 };
+int calls { 0 };
+
+struct counting_slot
+{
+	counting_slot() { constructed++; }
+	counting_slot(const counting_slot&) { constructed++; }
+	counting_slot(counting_slot&&) noexcept { constructed++; }
+	~counting_slot() { destroyed++; }
+
+	auto operator()() const -> void { calls++; }
+};
+
+auto reset_counts() -> void
+{
+	constructed = destroyed = calls = 0;
+}
+
+auto connect_and_erase() -> int
+{
+	reset_counts();
+
+	{
+		v::static_signal<void(), 4> signal;
+
+		auto a { signal >> counting_slot {} };
+		auto b { signal >> counting_slot {} };
+		auto c { signal >> counting_slot {} };
+
+		signal();
+		CHECK(calls == 3);
+
+		a.disconnect();
+		signal();
+		CHECK(calls == 5);
+
+		auto moved { std::move(signal) };
+
+		moved();
+		CHECK(calls == 7);
+	}
+
+	CHECK(constructed == destroyed);
+
+	return 0;
+}
+
+auto small_vector_storage() -> int
+{
+	reset_counts();
+
+	{
+		v::basic_signal<void(), v::threading::none, v::storage::small_vector<2>> signal;
+		std::vector<v::intrusive_cn> connections;
+
+		for (int i = 0; i < 8; i++) connections.push_back(signal >> counting_slot {});
+
+		connections.erase(connections.begin(), connections.begin() + 3);
+		signal();
+		CHECK(calls == 5);
+	}
+
+	CHECK(constructed == destroyed);
+
+	return 0;
+}
+
+auto lock_free_storage() -> int
+{
+	reset_counts();
+
+	{
+		v::basic_signal<void(), v::threading::lock_free, v::storage::inline_n<4>> signal;
+
+		auto a { signal >> counting_slot {} };
+		auto b { signal >> counting_slot {} };
+
+		a.disconnect();
+
+		auto moved { std::move(signal) };
+
+		moved();
+		CHECK(calls == 1);
+	}
+
+	CHECK(constructed == destroyed);
+
+	return 0;
+}
+
+auto observers() -> int
+{
+	auto calls { 0 };
+
+	v::static_property<int, 4> property { 1 };
+	v::static_getter<int, 4> getter { [&property] { return *property * 2; } };
+
+	v::intrusive_cn c { property >> [&calls] { calls++; } };
+	v::value_cn property_cn { property.observer(), [&calls] { calls += 10; } };
+	v::value_cn getter_cn { getter.observer(), [&calls] { calls += 100; } };
+
+	property.set(2);
+	getter.notify();
+
+	CHECK(calls == 111);
+	CHECK(getter_cn.get() == 4);
+
+	c.disconnect();
+	property.set(3);
+
+	CHECK(calls == 121);
+
+	return 0;
+}
+
+} // namespace
+
+int main()
+{
+	if (const auto result { connect_and_erase() }) return result;
+	if (const auto result { small_vector_storage() }) return result;
+	if (const auto result { lock_free_storage() }) return result;
+	if (const auto result { observers() }) return result;
+
+	return 0;
+}